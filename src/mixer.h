@@ -0,0 +1,311 @@
+// The soundtrack mixer: layer crossfade, remaster volume ceiling, blend ducking
+// and the enemy stem, advanced once per audio tick, and the channel map that
+// turns its gains into sequence channel volumes. soundtrack.c runs it on the
+// audio thread; the host tools in tools/ include the same file to replay a
+// trace or render a track, so there is one copy of the rules to keep right.
+//
+// Plain C with no decomp, recomp or libc dependencies. The includer defines
+// MIXER_SINF and MIXER_COSF for the crossfade curves before including it.
+// Static state and static inline functions, so a program that uses only part
+// of it builds without unused warnings; include it from one file per program.
+
+#ifndef MIXER_H
+#define MIXER_H
+
+#if !defined(MIXER_SINF) || !defined(MIXER_COSF)
+#error "define MIXER_SINF and MIXER_COSF before including mixer.h"
+#endif
+
+#define REMASTER_CHANNEL 0
+#define OST_CHANNEL 1
+#define MAX_LAYERS 4
+#define SEQ_CHANNEL_COUNT 16
+#define OST_VOLUME 1.0f               // between 0.0f - 2.0f
+#define CROSSFADE_DURATION_TICKS 180  // 180 ticks = 1 second
+
+// Blend intents arrive as 0..127; each source has its own duck curve.
+// Enemy blend ducks a bit more aggressively than ambient/spatial sub-BGM.
+#define BLEND_STEPS 128
+#define DUCK_ATTACK_COEF 0.10f  // per tick: ~55 ms time constant, settled within ~370 ms
+#define DUCK_RELEASE_COEF 0.02f // per tick: ~280 ms time constant, settled within ~1.9 s
+#define DUCK_EPSILON 0.001f
+
+// Requests from the game thread, see PostCommand. The numbering is part of
+// the event trace format ("C <op> <arg> <value>").
+typedef enum {
+    OST_CMD_SET_LAYER,  // crossfade to arg
+    OST_CMD_RESET,      // switch to arg immediately, no crossfade
+    OST_CMD_SET_VOLUME, // remaster volume ceiling
+    OST_CMD_SET_BLEND,  // blend intent of source arg (ostBlendSource), 0..127
+} ostCmdOp;
+
+typedef enum {
+    BLEND_SOURCE_ENEMY,
+    BLEND_SOURCE_SUB,
+    BLEND_SOURCE_COUNT
+} ostBlendSource;
+
+typedef struct {
+    int activeChannel;       // layer being faded in, -1 before the first command
+    int previousChannel;     // layer fading out while fadeTimer > 0
+    int fadeTimer;
+    float remasterVolumeMax;
+    float fadeInVolume;      // active layer, before ceiling and duck
+    float fadeOutVolume;     // previous layer, before ceiling and duck
+    unsigned char blendAmounts[BLEND_SOURCE_COUNT];
+    float bgmDuckTarget;
+    float bgmDuck;
+    // Enemy stems follow the enemy blend amount with the same smoothing as
+    // the duck.
+    float stemLevelTarget;
+    float stemLevel;
+    float stemVolume;
+} ostMixer;
+
+// Which sequence channels carry which layer, built at bind time from the track
+// count AudioAPI reports. Channels are laid out as stereo pairs cycling through
+// the track's layers; the even channel of each pair is the left side. An enemy
+// flagged track with one pair left over after its layers carries an enemy stem
+// in that last pair, faded in by the enemy blend amount.
+typedef struct {
+    unsigned char layerCount;
+    unsigned short layerMask[MAX_LAYERS]; // channels belonging to each layer
+    unsigned short stemMask;              // channels of the optional enemy stem
+    unsigned short leftMask;              // channels panned hard left when enforcing the stereo layout
+} ostChannelMap;
+
+static ostMixer mix;
+static float fadeInCurve[CROSSFADE_DURATION_TICKS];
+static float fadeOutCurve[CROSSFADE_DURATION_TICKS];
+static float duckTables[BLEND_SOURCE_COUNT][BLEND_STEPS];
+
+static inline void InitMixer(void) {
+    int i;
+
+    mix.activeChannel = -1;
+    mix.previousChannel = -1;
+    mix.fadeTimer = 0;
+    mix.remasterVolumeMax = 1.0f;
+    mix.fadeInVolume = 0.0f;
+    mix.fadeOutVolume = 0.0f;
+    mix.blendAmounts[BLEND_SOURCE_ENEMY] = 0;
+    mix.blendAmounts[BLEND_SOURCE_SUB] = 0;
+    mix.bgmDuckTarget = 1.0f;
+    mix.bgmDuck = 1.0f;
+    mix.stemLevelTarget = 0.0f;
+    mix.stemLevel = 0.0f;
+    mix.stemVolume = 0.0f;
+
+    for (i = 0; i < CROSSFADE_DURATION_TICKS; i++) {
+        fadeInCurve[i] = MIXER_SINF((float)i / CROSSFADE_DURATION_TICKS * 3.14159265f * 0.5f);
+        fadeOutCurve[i] = MIXER_COSF((float)i / CROSSFADE_DURATION_TICKS * 3.14159265f * 0.5f);
+    }
+
+    for (i = 0; i < BLEND_STEPS; i++) {
+        float amount = (float)i / (BLEND_STEPS - 1);
+
+        duckTables[BLEND_SOURCE_ENEMY][i] = 1.0f - (amount * amount) * 0.20f;
+        duckTables[BLEND_SOURCE_SUB][i] = 1.0f - amount * 0.12f;
+    }
+}
+
+// "Remaster Volume" option: 0 = "-3 dB", 1 = "0 dB", 2 = "+3 dB".
+static inline float GetRemasterVolume(unsigned long option) {
+    // -3 dB = 0.707, 0 dB = 1.0, +3 dB = 1.413
+    static const float kRemasterVolumeTable[] = { 0.707f, 1.0f, 1.413f };
+
+    if (option >= sizeof(kRemasterVolumeTable) / sizeof(kRemasterVolumeTable[0])) {
+        option = 1; // fallback to 0 dB
+    }
+    return kRemasterVolumeTable[option];
+}
+
+static inline float GetLayerCeiling(int channel) {
+    return (channel == REMASTER_CHANNEL) ? mix.remasterVolumeMax : OST_VOLUME;
+}
+
+// Applied from OST_CMD_SET_BLEND only: the combined duck is recomputed when an
+// intent changes, and each tick merely eases toward it.
+static inline void SetBlendAmount(ostBlendSource source, int volumeSplit) {
+    int amount = (volumeSplit < 0) ? 0 : (volumeSplit >= BLEND_STEPS) ? BLEND_STEPS - 1 : volumeSplit;
+    ostBlendSource other = (source == BLEND_SOURCE_ENEMY) ? BLEND_SOURCE_SUB : BLEND_SOURCE_ENEMY;
+    float duck;
+
+    // Enemy and sub-BGM blends are mutually exclusive; the latest one wins.
+    if (amount > 0) {
+        mix.blendAmounts[other] = 0;
+    }
+    mix.blendAmounts[source] = (unsigned char)amount;
+
+    mix.stemLevelTarget = (float)mix.blendAmounts[BLEND_SOURCE_ENEMY] / (BLEND_STEPS - 1);
+
+    duck = duckTables[BLEND_SOURCE_ENEMY][mix.blendAmounts[BLEND_SOURCE_ENEMY]] *
+           duckTables[BLEND_SOURCE_SUB][mix.blendAmounts[BLEND_SOURCE_SUB]];
+    mix.bgmDuckTarget = (duck < 0.0f) ? 0.0f : (duck > 1.0f) ? 1.0f : duck;
+}
+
+// The mixer's share of a drained command; other ops are the caller's.
+static inline void ApplyCommand(int op, int arg, float value) {
+    switch (op) {
+        case OST_CMD_SET_LAYER:
+            if (mix.activeChannel != arg) {
+                mix.previousChannel = mix.activeChannel;
+                mix.activeChannel = arg;
+                mix.fadeTimer = CROSSFADE_DURATION_TICKS;
+            }
+            break;
+
+        case OST_CMD_RESET:
+            mix.previousChannel = arg;
+            mix.activeChannel = arg;
+            mix.fadeTimer = 0;
+            break;
+
+        case OST_CMD_SET_VOLUME:
+            mix.remasterVolumeMax = value;
+            break;
+
+        case OST_CMD_SET_BLEND:
+            SetBlendAmount((ostBlendSource)arg, (int)value);
+            break;
+    }
+}
+
+// Eases value toward target: quickly while falling, slowly while rising.
+static inline void EaseToward(float* value, float target, float fallCoef, float riseCoef) {
+    float delta = target - *value;
+
+    if (delta == 0.0f) {
+        return;
+    }
+
+    if (delta > -DUCK_EPSILON && delta < DUCK_EPSILON) {
+        *value = target;
+    } else {
+        *value += delta * ((delta < 0.0f) ? fallCoef : riseCoef);
+    }
+}
+
+// One audio tick, after the tick's commands have been applied.
+static inline void StepMixer(void) {
+    if (mix.fadeTimer > 0) {
+        mix.fadeInVolume = fadeInCurve[CROSSFADE_DURATION_TICKS - mix.fadeTimer];
+        mix.fadeOutVolume = fadeOutCurve[CROSSFADE_DURATION_TICKS - mix.fadeTimer];
+        mix.fadeTimer--;
+    } else {
+        mix.fadeInVolume = 1.0f;
+        mix.fadeOutVolume = 0.0f;
+    }
+
+    EaseToward(&mix.bgmDuck, mix.bgmDuckTarget, DUCK_ATTACK_COEF, DUCK_RELEASE_COEF);
+
+    // The stem rises as the mix ducks and falls as it recovers, so it uses
+    // the duck's timings mirrored.
+    EaseToward(&mix.stemLevel, mix.stemLevelTarget, DUCK_RELEASE_COEF, DUCK_ATTACK_COEF);
+    mix.stemVolume = mix.stemLevel * GetLayerCeiling(mix.activeChannel);
+}
+
+// Main player gain of a layer.
+static inline float GetLayerGain(int layer) {
+    int active = (mix.activeChannel >= 0) ? mix.activeChannel : REMASTER_CHANNEL;
+    float level;
+
+    if (layer == active) {
+        level = mix.fadeInVolume;
+    } else if (layer == mix.previousChannel && mix.fadeOutVolume > 0.0f) {
+        level = mix.fadeOutVolume;
+    } else {
+        level = 0.0f;
+    }
+
+    return level * GetLayerCeiling(layer) * mix.bgmDuck;
+}
+
+// layers is the track's kSeqs .layers; enemy is set for OST_SEQ_FLAGS_ENEMY.
+static inline void BuildChannelMap(ostChannelMap* map, unsigned int trackCount, int layers, int enemy) {
+    unsigned int layerTracks;
+    unsigned int i;
+
+    layers = (layers < 1) ? 1 : (layers > MAX_LAYERS) ? MAX_LAYERS : layers;
+
+    // Unknown layout: cover every channel, as the alternating rule always did.
+    if (trackCount == 0 || trackCount > SEQ_CHANNEL_COUNT) {
+        trackCount = SEQ_CHANNEL_COUNT;
+        layerTracks = trackCount;
+    } else if (enemy && ((trackCount / 2) % layers) == 1 && trackCount / 2 > (unsigned int)layers) {
+        layerTracks = trackCount - 2;
+    } else {
+        layerTracks = trackCount;
+    }
+
+    map->layerCount = (unsigned char)layers;
+    for (i = 0; i < MAX_LAYERS; i++) {
+        map->layerMask[i] = 0;
+    }
+    map->stemMask = 0;
+    map->leftMask = 0;
+
+    for (i = 0; i < trackCount; i++) {
+        if (i < layerTracks) {
+            map->layerMask[(i / 2) % layers] |= 1 << i;
+        } else {
+            map->stemMask |= 1 << i;
+        }
+        if ((i % 2) == 0) {
+            map->leftMask |= 1 << i;
+        }
+    }
+}
+
+static inline unsigned int GetMappedChannels(const ostChannelMap* map) {
+    unsigned int mask = map->stemMask;
+    int layer;
+
+    for (layer = 0; layer < map->layerCount; layer++) {
+        mask |= map->layerMask[layer];
+    }
+
+    return mask;
+}
+
+// The volume of every channel of a player this tick: the active layer, the
+// outgoing one mid-crossfade (main player only) and the stem follow the mixer,
+// every other channel is held at zero. A layer the track lacks falls back to
+// the remaster. Returns the live channels: the active and outgoing layer and
+// any stem.
+static inline unsigned int GetChannelVolumes(const ostChannelMap* map, int mainPlayer,
+                                             float volumes[SEQ_CHANNEL_COUNT]) {
+    int active = (mix.activeChannel >= 0 && mix.activeChannel < map->layerCount) ? mix.activeChannel
+                                                                                : REMASTER_CHANNEL;
+    int outgoing = (mix.previousChannel >= 0 && mix.previousChannel < map->layerCount) ? mix.previousChannel
+                                                                                      : REMASTER_CHANNEL;
+    int fading = mainPlayer && mix.fadeOutVolume > 0.0f && outgoing != active;
+    unsigned int liveMask = map->layerMask[active] | map->stemMask;
+    float activeVolume = mainPlayer ? mix.fadeInVolume * GetLayerCeiling(active) * mix.bgmDuck
+                                    : GetLayerCeiling(active);
+    float outgoingVolume = mix.fadeOutVolume * GetLayerCeiling(outgoing) * mix.bgmDuck;
+    float stemVolume = mainPlayer ? mix.stemVolume : 0.0f;
+    int i;
+
+    if (fading) {
+        liveMask |= map->layerMask[outgoing];
+    }
+
+    for (i = 0; i < SEQ_CHANNEL_COUNT; i++) {
+        unsigned int bit = 1u << i;
+
+        if (map->layerMask[active] & bit) {
+            volumes[i] = activeVolume;
+        } else if (fading && (map->layerMask[outgoing] & bit)) {
+            volumes[i] = outgoingVolume;
+        } else if (map->stemMask & bit) {
+            volumes[i] = stemVolume;
+        } else {
+            volumes[i] = 0.0f;
+        }
+    }
+
+    return liveMask;
+}
+
+#endif
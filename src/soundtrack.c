@@ -4,31 +4,54 @@
 #include "audio_api/sequence.h"
 #include "audio_api/porcelain.h"
 #include "recomp/recompconfig.h"
+#include "recomp/recompui.h"
 
 RECOMP_IMPORT("magemods_audio_api", s32 AudioApi_GetSeqPlayerSeqId(SequencePlayer* seqPlayer));
 RECOMP_IMPORT("ProxyMM_Notifications", void Notifications_Emit(const char* prefix, const char* msg, const char* suffix));
 
-#define REMASTER_CHANNEL 0
-#define OST_CHANNEL 1
-#define OST_VOLUME 1.0f               // between 0.0f - 2.0f
-#define CROSSFADE_DURATION_TICKS 180  // 180 ticks = 1 second
-
-// -3 dB = 0.707, 0 dB = 1.0, +3 dB = 1.413
-static const f32 kRemasterVolumeTable[] = { 0.707f, 1.0f, 1.413f };
-
-static int activeChannel = -1;
-static f32 remasterVolumeMax = 1.0f;
-static f32 remasterVolume;
-static f32 ostVolume;
-static f32 remasterVolumeUnducked;
-static f32 ostVolumeUnducked;
-static f32 remasterVolumeSub;
-static f32 ostVolumeSub;
-static f32 enemyBlendAmount;
-static f32 subBlendAmount;
-static int fadeTimer;
-static f32 fadeInCurve[CROSSFADE_DURATION_TICKS];
-static f32 fadeOutCurve[CROSSFADE_DURATION_TICKS];
+// The mod makes no heap calls of its own: every table is sized at compile time
+// and filled in by onAudioApiInit. The poison below only stops this file from
+// naming the mod allocator; it cannot see what imports do internally
+// (recomp_printf behind TRACE, AudioAPI's stream cache, recompui). The mixer's
+// per-tick code in mixer.h is also checked on the host, where the tools abort
+// on any allocation during a simulated tick (tools/mix_model.h).
+#pragma GCC poison recomp_alloc recomp_free
+
+#define MIXER_SINF Math_SinF
+#define MIXER_COSF Math_CosF
+#include "mixer.h"
+
+// Selectable soundtrack layers, in L button cycling order. A track's stereo
+// pairs map to these in order; tracks with fewer layers fall back to the
+// remaster while a layer they lack is selected.
+static const char* const kLayerNames[] = {
+    "REMASTER", // REMASTER_CHANNEL
+    "CD OST",   // OST_CHANNEL
+};
+
+// Loop cache budget in MB: 0 = "Off", 1 = "64 MB", 2 = "128 MB", 3 = "256 MB"
+static const u32 kLoopCacheBudgetTable[] = { 0, 64, 128, 256 };
+
+// The mixer state in mixer.h belongs to the audio thread; the game thread
+// only reaches it through ostCmd. That includes the blend callbacks, which
+// AudioAPI fires from the game's Audio_Update.
+static int requestedChannel = -1;    // game thread's view of mix.activeChannel
+
+// Opt-in event trace for reproducing field reports. Every input the mixer
+// reacts to goes to the log as one "RST <tick> <event> <args>" line, stamped
+// with the audio tick it arrived on; tools/trace_replay.c runs a captured log
+// back through the same mixer (mixer.h) and prints the resulting gains per
+// tick. The mixer only sees what is logged, so a new input it reacts to needs
+// its own event here and in tools/mix_model.h.
+static bool traceEnabled;
+static u32 audioTick; // audio ticks since init
+
+#define TRACE(fmt, ...)                                                       \
+    do {                                                                      \
+        if (traceEnabled) {                                                   \
+            recomp_printf("RST %u " fmt "\n", audioTick, ##__VA_ARGS__);      \
+        }                                                                     \
+    } while (0)
 
 static int seqPlayers[] = {
     SEQ_PLAYER_BGM_MAIN,
@@ -41,6 +64,72 @@ static void ResetBgmChannelDisableMasks(void) {
     SEQCMD_SET_CHANNEL_DISABLE_MASK(SEQ_PLAYER_BGM_SUB, 0);
 }
 
+// State changes made on the game thread reach the audio thread through a
+// single-producer single-consumer ring: the game thread only advances
+// cmdWritePos, AudioScript_ProcessSequences only advances cmdReadPos, so
+// neither side ever blocks or sees a half-written command.
+#define CMD_QUEUE_SIZE 32 // power of two
+
+typedef struct {
+    u8 op;
+    u8 arg;
+    f32 value;
+} ostCmd;
+
+static ostCmd cmdQueue[CMD_QUEUE_SIZE];
+static volatile u32 cmdWritePos;
+static volatile u32 cmdReadPos;
+
+#define CMD_QUEUE_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+static void PostCommand(ostCmdOp op, u8 arg, f32 value) {
+    u32 pos = cmdWritePos;
+    ostCmd* cmd;
+
+    // Full: the audio thread has stalled for a whole queue's worth of
+    // requests. Dropping the newest keeps the ring consistent.
+    if (pos - cmdReadPos >= CMD_QUEUE_SIZE) {
+        return;
+    }
+
+    cmd = &cmdQueue[pos % CMD_QUEUE_SIZE];
+    cmd->op = op;
+    cmd->arg = arg;
+    cmd->value = value;
+
+    CMD_QUEUE_BARRIER();
+    cmdWritePos = pos + 1;
+}
+
+static void DrainCommands(void) {
+    u32 pos = cmdReadPos;
+    ostCmd* cmd;
+
+    while (pos != cmdWritePos) {
+        CMD_QUEUE_BARRIER();
+        cmd = &cmdQueue[pos % CMD_QUEUE_SIZE];
+
+        TRACE("C %d %d %d", cmd->op, cmd->arg, (s32)(cmd->value * 1000.0f + 0.5f));
+
+        ApplyCommand(cmd->op, cmd->arg, cmd->value);
+
+        pos++;
+        CMD_QUEUE_BARRIER();
+        cmdReadPos = pos;
+    }
+}
+
+static void NotifyActiveChannel(int channel) {
+    Notifications_Emit("Ben's RST", "Active:", kLayerNames[channel]);
+}
+
+static int GetConfigChannel(void) {
+    // Default soundtrack: index into kLayerNames
+    unsigned long channel = recomp_get_config_u32("default_soundtrack");
+
+    return (channel < ARRAY_COUNT(kLayerNames)) ? channel : REMASTER_CHANNEL;
+}
+
 typedef enum {
     STREAM_BGM = 0,
     STREAM_FANFARE = 1
@@ -60,131 +149,132 @@ typedef enum {
 
 typedef struct {
     s32 key;            // NA_BGM_* enum to replace
-    char file[64];      // writable filename buffer
+    const char* file;   // filename; pointer variants share their target's literal
     ostStreamKind kind; // STREAM_BGM or STREAM_FANFARE
     AudioApiSequenceIO seqIO; // sequence IO type (e.g. AUDIOAPI_SEQ_IO_BREMEN)
     ostSeqFlags flags;
     s8 volumeOffset;    // per-track volume offset
-    bool replaced;      // was the replacement successful
+    u8 layers;          // stereo pairs that are selectable layers (see kLayerNames)
 } ostSeqMap;
 
 
 // Keep only what you want replaced. Examples include your previous picks plus
 // pointer variants that map to their target’s filename.
-static ostSeqMap kSeqs[] = {
-    { NA_BGM_TERMINA_FIELD,            "NA_BGM_TERMINA_FIELD.ogg",            STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, false },
-    { NA_BGM_CHASE,                    "NA_BGM_CHASE.ogg",                    STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESTORE, 0, false },
-    { NA_BGM_MAJORAS_THEME,            "NA_BGM_MAJORAS_THEME.ogg",            STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_CLOCK_TOWER,              "NA_BGM_CLOCK_TOWER.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_STONE_TOWER_TEMPLE,       "NA_BGM_STONE_TOWER_TEMPLE.ogg",       STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, false },
-    { NA_BGM_INV_STONE_TOWER_TEMPLE,   "NA_BGM_INV_STONE_TOWER_TEMPLE.ogg",   STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, false },
-    { NA_BGM_FAILURE_0,                "NA_BGM_FAILURE_0.ogg",                STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_FAILURE_1,                "NA_BGM_FAILURE_1.ogg",                STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_HAPPY_MASK_SALESMAN,      "NA_BGM_HAPPY_MASK_SALESMAN.ogg",      STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_SONG_OF_HEALING,          "NA_BGM_SONG_OF_HEALING.ogg",          STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_SWAMP_REGION,             "NA_BGM_SWAMP_REGION.ogg",             STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, false },
-    { NA_BGM_ALIEN_INVASION,           "NA_BGM_ALIEN_INVASION.ogg",           STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_SWAMP_CRUISE,             "NA_BGM_SWAMP_CRUISE.ogg",             STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_SHARPS_CURSE,             "NA_BGM_SHARPS_CURSE.ogg",             STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_GREAT_BAY_REGION,         "NA_BGM_GREAT_BAY_REGION.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, false },
-    { NA_BGM_IKANA_REGION,             "NA_BGM_IKANA_REGION.ogg",             STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, false },
-    { NA_BGM_DEKU_PALACE,              "NA_BGM_DEKU_PALACE.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_MOUNTAIN_REGION,          "NA_BGM_MOUNTAIN_REGION.ogg",          STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, false },
-    { NA_BGM_PIRATES_FORTRESS,         "NA_BGM_PIRATES_FORTRESS.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_CLOCK_TOWN_DAY_1,         "NA_BGM_CLOCK_TOWN_DAY_1.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_CLOCK_TOWN_DAY_2,         "NA_BGM_CLOCK_TOWN_DAY_2.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_CLOCK_TOWN_DAY_3,         "NA_BGM_CLOCK_TOWN_DAY_3.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_FILE_SELECT,              "NA_BGM_FILE_SELECT.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_SKIP_HARP_INTRO, 0, false },
-    { NA_BGM_CLEAR_EVENT,              "NA_BGM_CLEAR_EVENT.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESUME, 0, false },
-    { NA_BGM_ENEMY,                    "NA_BGM_ENEMY.ogg",                    STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_BOSS,                     "NA_BGM_BOSS.ogg",                     STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESTORE, 0, false },
-    { NA_BGM_WOODFALL_TEMPLE,          "NA_BGM_WOODFALL_TEMPLE.ogg",          STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, false },
-    { NA_BGM_OPENING,                  "NA_BGM_OPENING.ogg",                  STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_INSIDE_A_HOUSE,           "NA_BGM_INSIDE_A_HOUSE.ogg",           STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESUME_PREV, 0, false },
-    { NA_BGM_GAME_OVER,                "NA_BGM_GAME_OVER.ogg",                STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_CLEAR_BOSS,               "NA_BGM_CLEAR_BOSS.ogg",               STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_GET_ITEM,                 "NA_BGM_GET_ITEM.ogg",                 STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_GET_HEART,                "NA_BGM_GET_HEART.ogg",                STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_TIMED_MINI_GAME,          "NA_BGM_TIMED_MINI_GAME.ogg",          STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESTORE, 0, false },
-    { NA_BGM_GORON_RACE,               "NA_BGM_GORON_RACE.ogg",               STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_MUSIC_BOX_HOUSE,          "NA_BGM_MUSIC_BOX_HOUSE.ogg",          STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_ZELDAS_LULLABY,           "NA_BGM_ZELDAS_LULLABY.ogg",           STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_ROSA_SISTERS,             "NA_BGM_ROSA_SISTERS.ogg",             STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_OPEN_CHEST,               "NA_BGM_OPEN_CHEST.ogg",               STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_MARINE_RESEARCH_LAB,      "NA_BGM_MARINE_RESEARCH_LAB.ogg",      STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_GIANTS_THEME,             "NA_BGM_GIANTS_THEME.ogg",             STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_SKIP_HARP_INTRO, 0, false },
-    { NA_BGM_SONG_OF_STORMS,           "NA_BGM_SONG_OF_STORMS.ogg",           STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_ROMANI_RANCH,             "NA_BGM_ROMANI_RANCH.ogg",             STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_GORON_VILLAGE,            "NA_BGM_GORON_VILLAGE.ogg",            STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_MAYORS_OFFICE,            "NA_BGM_MAYORS_OFFICE.ogg",            STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_ZORA_HALL,                "NA_BGM_ZORA_HALL.ogg",                STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESUME, 0, false },
-    { NA_BGM_GET_NEW_MASK,             "NA_BGM_GET_NEW_MASK.ogg",             STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_MINI_BOSS,                "NA_BGM_MINI_BOSS.ogg",                STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESTORE, 0, false },
-    { NA_BGM_GET_SMALL_ITEM,           "NA_BGM_GET_SMALL_ITEM.ogg",           STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_ASTRAL_OBSERVATORY,       "NA_BGM_ASTRAL_OBSERVATORY.ogg",       STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_CAVERN,                   "NA_BGM_CAVERN.ogg",                   STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, false },
-    { NA_BGM_MILK_BAR,                 "NA_BGM_MILK_BAR.ogg",                 STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESUME | OST_SEQ_FLAGS_ENEMY, 0, false },
-    { NA_BGM_ZELDA_APPEAR,             "NA_BGM_ZELDA_APPEAR.ogg",             STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_SARIAS_SONG,              "NA_BGM_SARIAS_SONG.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_GORON_GOAL,               "NA_BGM_GORON_GOAL.ogg",               STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_HORSE,                    "NA_BGM_HORSE.ogg",                    STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_HORSE_GOAL,               "NA_BGM_HORSE_GOAL.ogg",               STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_INGO,                     "NA_BGM_INGO.ogg",                     STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_KOTAKE_POTION_SHOP,       "NA_BGM_KOTAKE_POTION_SHOP.ogg",       STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_SHOP,                     "NA_BGM_SHOP.ogg",                     STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESUME_PREV, 0, false },
-    { NA_BGM_OWL,                      "NA_BGM_OWL.ogg",                      STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_SHOOTING_GALLERY,         "NA_BGM_SHOOTING_GALLERY.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESUME_PREV, 0, false },
-    { NA_BGM_SONATA_OF_AWAKENING,      "NA_BGM_SONATA_OF_AWAKENING.ogg",      STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_GORON_LULLABY,            "NA_BGM_GORON_LULLABY.ogg",            STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_NEW_WAVE_BOSSA_NOVA,      "NA_BGM_NEW_WAVE_BOSSA_NOVA.ogg",      STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_NEW_WAVE_SAXOPHONE,       "NA_BGM_NEW_WAVE_BOSSA_NOVA.ogg",      STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_NEW_WAVE_VOCAL,           "NA_BGM_NEW_WAVE_VOCAL.ogg",           STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_ELEGY_OF_EMPTINESS,       "NA_BGM_ELEGY_OF_EMPTINESS.ogg",       STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_OATH_TO_ORDER,            "NA_BGM_OATH_TO_ORDER.ogg",            STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_SWORD_TRAINING_HALL,      "NA_BGM_SWORD_TRAINING_HALL.ogg",      STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_LEARNED_NEW_SONG,         "NA_BGM_LEARNED_NEW_SONG.ogg",         STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_BREMEN_MARCH,             "NA_BGM_BREMEN_MARCH.ogg",             STREAM_FANFARE, AUDIOAPI_SEQ_IO_BREMEN, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_BALLAD_OF_THE_WIND_FISH,  "NA_BGM_BALLAD_OF_THE_WIND_FISH.ogg",  STREAM_FANFARE, AUDIOAPI_SEQ_IO_WINDFISH, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_SONG_OF_SOARING,          "NA_BGM_SONG_OF_SOARING.ogg",          STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESTORE, 0, false },
-    { NA_BGM_FINAL_HOURS,              "NA_BGM_FINAL_HOURS.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_MIKAU_RIFF,               "NA_BGM_MIKAU_RIFF.ogg",               STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_MIKAU_FINALE,             "NA_BGM_MIKAU_FINALE.ogg",             STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_FROG_SONG,                "NA_BGM_FROG_SONG.ogg",                STREAM_BGM,     AUDIOAPI_SEQ_IO_FROG, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_PIANO_SESSION,            "NA_BGM_PIANO_SESSION.ogg",            STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_INDIGO_GO_SESSION,        "NA_BGM_INDIGO_GO_SESSION.ogg",        STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_SNOWHEAD_TEMPLE,          "NA_BGM_SNOWHEAD_TEMPLE.ogg",          STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, false },
-    { NA_BGM_GREAT_BAY_TEMPLE,         "NA_BGM_GREAT_BAY_TEMPLE.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, false },
-    { NA_BGM_MAJORAS_WRATH,            "NA_BGM_MAJORAS_WRATH.ogg",            STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_MAJORAS_INCARNATION,      "NA_BGM_MAJORAS_INCARNATION.ogg",      STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_MAJORAS_MASK,             "NA_BGM_MAJORAS_MASK.ogg",             STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_BASS_PLAY,                "NA_BGM_BASS_PLAY.ogg",                STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_DRUMS_PLAY,               "NA_BGM_DRUMS_PLAY.ogg",               STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_PIANO_PLAY,               "NA_BGM_PIANO_PLAY.ogg",               STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_IKANA_CASTLE,             "NA_BGM_IKANA_CASTLE.ogg",             STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, false },
-    { NA_BGM_GATHERING_GIANTS,         "NA_BGM_GATHERING_GIANTS.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_KAMARO_DANCE,             "NA_BGM_KAMARO_DANCE.ogg",             STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE_KAMARO, 0, false },
-    { NA_BGM_CREMIA_CARRIAGE,          "NA_BGM_CREMIA_CARRIAGE.ogg",          STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_KEATON_QUIZ,              "NA_BGM_KEATON_QUIZ.ogg",              STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_END_CREDITS,              "NA_BGM_END_CREDITS.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_CREDITS_1, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_TITLE_THEME,              "NA_BGM_TITLE_THEME.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_DUNGEON_APPEAR,           "NA_BGM_DUNGEON_APPEAR.ogg",           STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_WOODFALL_CLEAR,           "NA_BGM_WOODFALL_CLEAR.ogg",           STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_SNOWHEAD_CLEAR,           "NA_BGM_SNOWHEAD_CLEAR.ogg",           STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_INTO_THE_MOON,            "NA_BGM_INTO_THE_MOON.ogg",            STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_GOODBYE_GIANT,            "NA_BGM_GOODBYE_GIANT.ogg",            STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_TATL_AND_TAEL,            "NA_BGM_TATL_AND_TAEL.ogg",            STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_MOONS_DESTRUCTION,        "NA_BGM_MOONS_DESTRUCTION.ogg",        STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_OCARINA_GUITAR_BASS_SESSION,"NA_BGM_OCARINA_GUITAR_BASS_SESSION.ogg",STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false }, // Not Ocarina
-    { NA_BGM_END_CREDITS_SECOND_HALF,  "NA_BGM_END_CREDITS_SECOND_HALF.ogg",  STREAM_BGM,     AUDIOAPI_SEQ_IO_CREDITS_2, OST_SEQ_FLAGS_NONE, 0, false },
-    { NB_BGM_MORNING, "NB_BGM_MORNING.ogg", STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
+static const ostSeqMap kSeqs[] = {
+    { NA_BGM_TERMINA_FIELD,            "NA_BGM_TERMINA_FIELD.ogg",            STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, 2 },
+    { NA_BGM_CHASE,                    "NA_BGM_CHASE.ogg",                    STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESTORE, 0, 2 },
+    { NA_BGM_MAJORAS_THEME,            "NA_BGM_MAJORAS_THEME.ogg",            STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_CLOCK_TOWER,              "NA_BGM_CLOCK_TOWER.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_STONE_TOWER_TEMPLE,       "NA_BGM_STONE_TOWER_TEMPLE.ogg",       STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, 2 },
+    { NA_BGM_INV_STONE_TOWER_TEMPLE,   "NA_BGM_INV_STONE_TOWER_TEMPLE.ogg",   STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, 2 },
+    { NA_BGM_FAILURE_0,                "NA_BGM_FAILURE_0.ogg",                STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_FAILURE_1,                "NA_BGM_FAILURE_1.ogg",                STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_HAPPY_MASK_SALESMAN,      "NA_BGM_HAPPY_MASK_SALESMAN.ogg",      STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_SONG_OF_HEALING,          "NA_BGM_SONG_OF_HEALING.ogg",          STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_SWAMP_REGION,             "NA_BGM_SWAMP_REGION.ogg",             STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, 2 },
+    { NA_BGM_ALIEN_INVASION,           "NA_BGM_ALIEN_INVASION.ogg",           STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_SWAMP_CRUISE,             "NA_BGM_SWAMP_CRUISE.ogg",             STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_SHARPS_CURSE,             "NA_BGM_SHARPS_CURSE.ogg",             STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_GREAT_BAY_REGION,         "NA_BGM_GREAT_BAY_REGION.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, 2 },
+    { NA_BGM_IKANA_REGION,             "NA_BGM_IKANA_REGION.ogg",             STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, 2 },
+    { NA_BGM_DEKU_PALACE,              "NA_BGM_DEKU_PALACE.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_MOUNTAIN_REGION,          "NA_BGM_MOUNTAIN_REGION.ogg",          STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, 2 },
+    { NA_BGM_PIRATES_FORTRESS,         "NA_BGM_PIRATES_FORTRESS.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_CLOCK_TOWN_DAY_1,         "NA_BGM_CLOCK_TOWN_DAY_1.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_CLOCK_TOWN_DAY_2,         "NA_BGM_CLOCK_TOWN_DAY_2.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_CLOCK_TOWN_DAY_3,         "NA_BGM_CLOCK_TOWN_DAY_3.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_FILE_SELECT,              "NA_BGM_FILE_SELECT.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_SKIP_HARP_INTRO, 0, 2 },
+    { NA_BGM_CLEAR_EVENT,              "NA_BGM_CLEAR_EVENT.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESUME, 0, 2 },
+    { NA_BGM_ENEMY,                    "NA_BGM_ENEMY.ogg",                    STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_BOSS,                     "NA_BGM_BOSS.ogg",                     STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESTORE, 0, 2 },
+    { NA_BGM_WOODFALL_TEMPLE,          "NA_BGM_WOODFALL_TEMPLE.ogg",          STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, 2 },
+    { NA_BGM_OPENING,                  "NA_BGM_OPENING.ogg",                  STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_INSIDE_A_HOUSE,           "NA_BGM_INSIDE_A_HOUSE.ogg",           STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESUME_PREV, 0, 2 },
+    { NA_BGM_GAME_OVER,                "NA_BGM_GAME_OVER.ogg",                STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_CLEAR_BOSS,               "NA_BGM_CLEAR_BOSS.ogg",               STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_GET_ITEM,                 "NA_BGM_GET_ITEM.ogg",                 STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_GET_HEART,                "NA_BGM_GET_HEART.ogg",                STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_TIMED_MINI_GAME,          "NA_BGM_TIMED_MINI_GAME.ogg",          STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESTORE, 0, 2 },
+    { NA_BGM_GORON_RACE,               "NA_BGM_GORON_RACE.ogg",               STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_MUSIC_BOX_HOUSE,          "NA_BGM_MUSIC_BOX_HOUSE.ogg",          STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_ZELDAS_LULLABY,           "NA_BGM_ZELDAS_LULLABY.ogg",           STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_ROSA_SISTERS,             "NA_BGM_ROSA_SISTERS.ogg",             STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_OPEN_CHEST,               "NA_BGM_OPEN_CHEST.ogg",               STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_MARINE_RESEARCH_LAB,      "NA_BGM_MARINE_RESEARCH_LAB.ogg",      STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_GIANTS_THEME,             "NA_BGM_GIANTS_THEME.ogg",             STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_SKIP_HARP_INTRO, 0, 2 },
+    { NA_BGM_SONG_OF_STORMS,           "NA_BGM_SONG_OF_STORMS.ogg",           STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_ROMANI_RANCH,             "NA_BGM_ROMANI_RANCH.ogg",             STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_GORON_VILLAGE,            "NA_BGM_GORON_VILLAGE.ogg",            STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_MAYORS_OFFICE,            "NA_BGM_MAYORS_OFFICE.ogg",            STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_ZORA_HALL,                "NA_BGM_ZORA_HALL.ogg",                STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESUME, 0, 2 },
+    { NA_BGM_GET_NEW_MASK,             "NA_BGM_GET_NEW_MASK.ogg",             STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_MINI_BOSS,                "NA_BGM_MINI_BOSS.ogg",                STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESTORE, 0, 2 },
+    { NA_BGM_GET_SMALL_ITEM,           "NA_BGM_GET_SMALL_ITEM.ogg",           STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_ASTRAL_OBSERVATORY,       "NA_BGM_ASTRAL_OBSERVATORY.ogg",       STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_CAVERN,                   "NA_BGM_CAVERN.ogg",                   STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, 2 },
+    { NA_BGM_MILK_BAR,                 "NA_BGM_MILK_BAR.ogg",                 STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESUME | OST_SEQ_FLAGS_ENEMY, 0, 2 },
+    { NA_BGM_ZELDA_APPEAR,             "NA_BGM_ZELDA_APPEAR.ogg",             STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_SARIAS_SONG,              "NA_BGM_SARIAS_SONG.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_GORON_GOAL,               "NA_BGM_GORON_GOAL.ogg",               STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_HORSE,                    "NA_BGM_HORSE.ogg",                    STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_HORSE_GOAL,               "NA_BGM_HORSE_GOAL.ogg",               STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_INGO,                     "NA_BGM_INGO.ogg",                     STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_KOTAKE_POTION_SHOP,       "NA_BGM_KOTAKE_POTION_SHOP.ogg",       STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_SHOP,                     "NA_BGM_SHOP.ogg",                     STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESUME_PREV, 0, 2 },
+    { NA_BGM_OWL,                      "NA_BGM_OWL.ogg",                      STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_SHOOTING_GALLERY,         "NA_BGM_SHOOTING_GALLERY.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESUME_PREV, 0, 2 },
+    { NA_BGM_SONATA_OF_AWAKENING,      "NA_BGM_SONATA_OF_AWAKENING.ogg",      STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_GORON_LULLABY,            "NA_BGM_GORON_LULLABY.ogg",            STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_NEW_WAVE_BOSSA_NOVA,      "NA_BGM_NEW_WAVE_BOSSA_NOVA.ogg",      STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_NEW_WAVE_SAXOPHONE,       "NA_BGM_NEW_WAVE_BOSSA_NOVA.ogg",      STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_NEW_WAVE_VOCAL,           "NA_BGM_NEW_WAVE_VOCAL.ogg",           STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_ELEGY_OF_EMPTINESS,       "NA_BGM_ELEGY_OF_EMPTINESS.ogg",       STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_OATH_TO_ORDER,            "NA_BGM_OATH_TO_ORDER.ogg",            STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_SWORD_TRAINING_HALL,      "NA_BGM_SWORD_TRAINING_HALL.ogg",      STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_LEARNED_NEW_SONG,         "NA_BGM_LEARNED_NEW_SONG.ogg",         STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_BREMEN_MARCH,             "NA_BGM_BREMEN_MARCH.ogg",             STREAM_FANFARE, AUDIOAPI_SEQ_IO_BREMEN, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_BALLAD_OF_THE_WIND_FISH,  "NA_BGM_BALLAD_OF_THE_WIND_FISH.ogg",  STREAM_FANFARE, AUDIOAPI_SEQ_IO_WINDFISH, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_SONG_OF_SOARING,          "NA_BGM_SONG_OF_SOARING.ogg",          STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_RESTORE, 0, 2 },
+    { NA_BGM_FINAL_HOURS,              "NA_BGM_FINAL_HOURS.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_MIKAU_RIFF,               "NA_BGM_MIKAU_RIFF.ogg",               STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_MIKAU_FINALE,             "NA_BGM_MIKAU_FINALE.ogg",             STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_FROG_SONG,                "NA_BGM_FROG_SONG.ogg",                STREAM_BGM,     AUDIOAPI_SEQ_IO_FROG, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_PIANO_SESSION,            "NA_BGM_PIANO_SESSION.ogg",            STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_INDIGO_GO_SESSION,        "NA_BGM_INDIGO_GO_SESSION.ogg",        STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_SNOWHEAD_TEMPLE,          "NA_BGM_SNOWHEAD_TEMPLE.ogg",          STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, 2 },
+    { NA_BGM_GREAT_BAY_TEMPLE,         "NA_BGM_GREAT_BAY_TEMPLE.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, 2 },
+    { NA_BGM_MAJORAS_WRATH,            "NA_BGM_MAJORAS_WRATH.ogg",            STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_MAJORAS_INCARNATION,      "NA_BGM_MAJORAS_INCARNATION.ogg",      STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_MAJORAS_MASK,             "NA_BGM_MAJORAS_MASK.ogg",             STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_BASS_PLAY,                "NA_BGM_BASS_PLAY.ogg",                STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_DRUMS_PLAY,               "NA_BGM_DRUMS_PLAY.ogg",               STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_PIANO_PLAY,               "NA_BGM_PIANO_PLAY.ogg",               STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_IKANA_CASTLE,             "NA_BGM_IKANA_CASTLE.ogg",             STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_ENEMY, 0, 2 },
+    { NA_BGM_GATHERING_GIANTS,         "NA_BGM_GATHERING_GIANTS.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_KAMARO_DANCE,             "NA_BGM_KAMARO_DANCE.ogg",             STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE_KAMARO, 0, 2 },
+    { NA_BGM_CREMIA_CARRIAGE,          "NA_BGM_CREMIA_CARRIAGE.ogg",          STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_KEATON_QUIZ,              "NA_BGM_KEATON_QUIZ.ogg",              STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_END_CREDITS,              "NA_BGM_END_CREDITS.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_CREDITS_1, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_TITLE_THEME,              "NA_BGM_TITLE_THEME.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_DUNGEON_APPEAR,           "NA_BGM_DUNGEON_APPEAR.ogg",           STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_WOODFALL_CLEAR,           "NA_BGM_WOODFALL_CLEAR.ogg",           STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_SNOWHEAD_CLEAR,           "NA_BGM_SNOWHEAD_CLEAR.ogg",           STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_INTO_THE_MOON,            "NA_BGM_INTO_THE_MOON.ogg",            STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_GOODBYE_GIANT,            "NA_BGM_GOODBYE_GIANT.ogg",            STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_TATL_AND_TAEL,            "NA_BGM_TATL_AND_TAEL.ogg",            STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_MOONS_DESTRUCTION,        "NA_BGM_MOONS_DESTRUCTION.ogg",        STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_OCARINA_GUITAR_BASS_SESSION,"NA_BGM_OCARINA_GUITAR_BASS_SESSION.ogg",STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 }, // Not Ocarina
+    { NA_BGM_END_CREDITS_SECOND_HALF,  "NA_BGM_END_CREDITS_SECOND_HALF.ogg",  STREAM_BGM,     AUDIOAPI_SEQ_IO_CREDITS_2, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NB_BGM_MORNING, "NB_BGM_MORNING.ogg", STREAM_FANFARE, AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
 
     // // --- POINTER VARIANTS ---
-    { NA_BGM_CLOCK_TOWN_DAY_2_PTR,     "NA_BGM_CLOCK_TOWN_DAY_2.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, false },
-    { NA_BGM_FAIRY_FOUNTAIN,           "NA_BGM_FAIRY_FOUNTAIN.ogg",           STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_MILK_BAR_DUPLICATE,       "NA_BGM_MILK_BAR.ogg",                 STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
-    { NA_BGM_MAJORAS_LAIR,             "NA_BGM_FINAL_HOURS.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, false },
+    { NA_BGM_CLOCK_TOWN_DAY_2_PTR,     "NA_BGM_CLOCK_TOWN_DAY_2.ogg",         STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_FANFARE, 0, 2 },
+    { NA_BGM_FAIRY_FOUNTAIN,           "NA_BGM_FAIRY_FOUNTAIN.ogg",           STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_MILK_BAR_DUPLICATE,       "NA_BGM_MILK_BAR.ogg",                 STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
+    { NA_BGM_MAJORAS_LAIR,             "NA_BGM_FINAL_HOURS.ogg",              STREAM_BGM,     AUDIOAPI_SEQ_IO_NONE, OST_SEQ_FLAGS_NONE, 0, 2 },
 
     // // --- Ocarina Songs ---
+    // Short, time-critical cues: once these ship, add them to kPreloadCues too.
     // { NA_BGM_OCARINA_LULLABY_INTRO_PTR,"NA_BGM_OCARINA_LULLABY_INTRO.ogg",    STREAM_FANFARE, false }, // POINTER!!!
     // { NA_BGM_OCARINA_LULLABY_INTRO,    "NA_BGM_OCARINA_LULLABY_INTRO.ogg",    STREAM_FANFARE, false },
     // { NA_BGM_OCARINA_EPONA,            "NA_BGM_OCARINA_EPONA.ogg",            STREAM_FANFARE, false },
@@ -206,266 +296,1056 @@ static ostSeqMap kSeqs[] = {
     // { NA_BGM_SEQ_122,                  "NA_BGM_SEQ_122.ogg",                  STREAM_BGM,     false },
 };
 
+// Runtime view of a bound track. kSeqs is only read while binding; everything
+// the audio hooks look at per tick lives in this compact array instead.
+typedef struct {
+    s16 key;            // NA_BGM_* enum being replaced
+    s16 streamId;       // sequence AudioAPI generated for the file, shared by aliases
+    u8 flags;           // ostSeqFlags, as handed to AudioApi_SetSequenceFlags
+    u8 spec;            // index into kSeqs
+    u8 trackCount;      // as reported when the stream was created
+    u32 resourceId;     // the stream's file, for WarmSequence
+    ostChannelMap channels;
+} ostSeqState;
+
+static ostSeqState seqStates[ARRAY_COUNT(kSeqs)];
+static int seqStateCount;
+static u32 replacedBits[(ARRAY_COUNT(kSeqs) + 31) / 32]; // per kSeqs entry
+
+static bool IsSpecReplaced(const ostSeqMap* spec) {
+    int idx = spec - kSeqs;
+
+    return (replacedBits[idx / 32] >> (idx % 32)) & 1;
+}
+
+// Long-running area tracks worth keeping resident after their first play,
+// most valuable first. Each one is pinned in this order for as long as its
+// whole file still fits in the loop cache budget. The rest are cached on use
+// but stay evictable; which of them goes first is up to AudioAPI's cache,
+// which takes no eviction hint, so a track that is playing is not protected
+// over one that is not. The pinned set itself is chosen at bind time, since
+// AudioAPI only takes a cache strategy when the stream is created.
+// The Clock Town day themes and Final Hours come back every cycle, so they
+// rank just below Termina Field; each is pinned on its own merits, so a small
+// budget can hold some of them and not others. With the three-day warm-up on
+// they are left out of the budget entirely, see kClockCues.
+static const s32 kLoopCacheTracks[] = {
+    NA_BGM_TERMINA_FIELD,
+    NA_BGM_CLOCK_TOWN_DAY_1,
+    NA_BGM_CLOCK_TOWN_DAY_2,
+    NA_BGM_CLOCK_TOWN_DAY_3,
+    NA_BGM_FINAL_HOURS,
+    NA_BGM_SWAMP_REGION,
+    NA_BGM_MOUNTAIN_REGION,
+    NA_BGM_GREAT_BAY_REGION,
+    NA_BGM_IKANA_REGION,
+    NA_BGM_WOODFALL_TEMPLE,
+    NA_BGM_SNOWHEAD_TEMPLE,
+    NA_BGM_GREAT_BAY_TEMPLE,
+    NA_BGM_STONE_TOWER_TEMPLE,
+    NA_BGM_INV_STONE_TOWER_TEMPLE,
+};
+
+// Size in bytes of each file in the pack, written by the Makefile from the
+// files in AUDIO_DIR when the mod is built. Empty when the build had no audio
+// folder, in which case nothing is pinned.
+typedef struct {
+    const char* file;
+    u32 size;
+} ostFileSize;
+
+static const ostFileSize kFileSizes[] = {
+#include "audio_sizes.h"
+    { NULL, 0 },
+};
+
+// Short fanfares that have to start on the exact frame the game asks for them.
+// They are small enough to keep fully in memory from init, so playback never
+// waits on the stream reader.
+static const s32 kPreloadCues[] = {
+    NA_BGM_GET_ITEM,
+    NA_BGM_GET_HEART,
+    NA_BGM_GET_SMALL_ITEM,
+    NA_BGM_GET_NEW_MASK,
+    NA_BGM_OPEN_CHEST,
+    NA_BGM_LEARNED_NEW_SONG,
+    NA_BGM_FAILURE_0,
+    NA_BGM_FAILURE_1,
+    NA_BGM_ZELDA_APPEAR,
+    NA_BGM_DUNGEON_APPEAR,
+};
+
+// Indigo-Go's session pieces come in on the beat of the player's performance,
+// so a late first buffer is audible as being off-tempo. They are only heard
+// in the band's rehearsal room, though, so rather than holding them from init
+// they are cached on use and warmed as soon as that scene loads, before the
+// first take can start (see UpdateSessionWarm).
+static const s32 kSessionCues[] = {
+    NA_BGM_PIANO_SESSION,
+    NA_BGM_INDIGO_GO_SESSION,
+    NA_BGM_BASS_PLAY,
+    NA_BGM_DRUMS_PLAY,
+    NA_BGM_PIANO_PLAY,
+    NA_BGM_OCARINA_GUITAR_BASS_SESSION,
+};
+
+// Tracks the game tends to stop and start again within seconds: mini-game
+// retries, races, battles that end and re-aggro. Caching them on use lets a
+// restart rewind in memory instead of reopening and re-decoding the file.
+static const s32 kRetriggerTracks[] = {
+    NA_BGM_TIMED_MINI_GAME,
+    NA_BGM_GORON_RACE,
+    NA_BGM_HORSE,
+    NA_BGM_SWORD_TRAINING_HALL,
+    NA_BGM_ENEMY,
+    NA_BGM_CHASE,
+    NA_BGM_MINI_BOSS,
+    NA_BGM_BOSS,
+};
+
+// Entries that may reuse the stream of another entry playing the same file.
+// A stream has one read cursor, so only keys that can never sound at the same
+// time as their twin are listed: Majora's Lair plays on the moon, where Final
+// Hours has already been stopped for good. The other duplicates (Milk Bar,
+// the Day 2 pointer, the New Wave variants) can overlap their twin on another
+// player and keep a stream of their own.
+static const s32 kSharedStreamTracks[] = {
+    NA_BGM_MAJORAS_LAIR,
+};
+
+// When the three-day clock brings in each Clock Town track, in hours since
+// the dawn of the first day. The planner warms each one from the hour before
+// until it starts. The first day's theme is not listed: the Song of Time
+// jumps straight to it, so there is no hour before to warm it in.
+typedef struct {
+    s32 key;
+    u8 dueHour;
+} ostClockCue;
+
+static const ostClockCue kClockCues[] = {
+    { NA_BGM_CLOCK_TOWN_DAY_2, 24 }, // dawn of the second day
+    { NA_BGM_CLOCK_TOWN_DAY_3, 48 }, // dawn of the final day
+    { NA_BGM_FINAL_HOURS, 66 },      // midnight of the final night
+};
+
 // [BENS-STREAMED-AUDIO CONFIG END]
 // -----------------------------------------------------------------------------
 
-static void LoadAndBindStreamedSequence(ostSeqMap* spec) {
+static bool loopCacheEnabled;
+static u32 loopCacheBudget; // remaining bytes of pinned files we may add
+static bool warmResumeEnabled;
+static bool preloadCuesEnabled;
+static bool retriggerCacheEnabled;
+static bool clockWarmEnabled;
+
+static bool IsLoopCacheTrack(s32 seqId) {
+    int i;
+
+    for (i = 0; i < ARRAY_COUNT(kLoopCacheTracks); ++i) {
+        if (kLoopCacheTracks[i] == seqId) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool IsPreloadCue(s32 seqId) {
+    int i;
+
+    for (i = 0; i < ARRAY_COUNT(kPreloadCues); ++i) {
+        if (kPreloadCues[i] == seqId) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool IsSessionCue(s32 seqId) {
+    int i;
+
+    for (i = 0; i < ARRAY_COUNT(kSessionCues); ++i) {
+        if (kSessionCues[i] == seqId) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool IsSharedStreamTrack(s32 seqId) {
+    int i;
+
+    for (i = 0; i < ARRAY_COUNT(kSharedStreamTracks); ++i) {
+        if (kSharedStreamTracks[i] == seqId) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool IsClockCue(s32 seqId) {
+    int i;
+
+    for (i = 0; i < ARRAY_COUNT(kClockCues); ++i) {
+        if (kClockCues[i].key == seqId) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool IsRetriggerTrack(s32 seqId) {
+    int i;
+
+    for (i = 0; i < ARRAY_COUNT(kRetriggerTracks); ++i) {
+        if (kRetriggerTracks[i] == seqId) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// pinnedBytes is what the track would hold once pinned, see GetPinnedBytes.
+static AudioApiCacheStrategy GetCacheStrategy(const ostSeqMap* spec, u32 pinnedBytes) {
+    // The clock tracks are warmed and let go by the three-day planner, which
+    // needs them cached on use but never pinned: a pinned day theme would
+    // outlive its day.
+    if (clockWarmEnabled && IsClockCue(spec->key)) {
+        return AUDIOAPI_CACHE_PRELOAD_ON_USE;
+    }
+
+    if (loopCacheEnabled && IsLoopCacheTrack(spec->key)) {
+        // Keep the file resident once the first play has pulled it in, if it
+        // fits in what is left of the budget. Otherwise still cache it on use,
+        // but let AudioAPI evict it when something else needs the room.
+        return (pinnedBytes != 0 && pinnedBytes <= loopCacheBudget)
+            ? AUDIOAPI_CACHE_PRELOAD_ON_USE_NO_EVICT
+            : AUDIOAPI_CACHE_PRELOAD_ON_USE;
+    }
+
+    if (preloadCuesEnabled && IsPreloadCue(spec->key)) {
+        return AUDIOAPI_CACHE_PRELOAD;
+    }
+
+    if (preloadCuesEnabled && IsSessionCue(spec->key)) {
+        return AUDIOAPI_CACHE_PRELOAD_ON_USE;
+    }
+
+    // Tracks the player keeps walking in and out of stay cached after they
+    // stop, so a resume seeks in memory instead of reopening the file.
+    // They remain evictable: the cache decides how long they stay warm.
+    if (warmResumeEnabled && (spec->flags & (OST_SEQ_FLAGS_RESUME | OST_SEQ_FLAGS_RESUME_PREV))) {
+        return AUDIOAPI_CACHE_PRELOAD_ON_USE;
+    }
+
+    // Same for tracks restarted from the top in quick succession: the
+    // restart is served from the copy the previous run pulled in, for as
+    // long as the cache keeps it.
+    if (retriggerCacheEnabled && IsRetriggerTrack(spec->key)) {
+        return AUDIOAPI_CACHE_PRELOAD_ON_USE;
+    }
+
+    // The harp intro skip seeks on the very first play, so load these whole
+    // up front: the seek becomes a lookup in memory rather than a bisection
+    // over pages read from disk.
+    if (spec->flags & OST_SEQ_FLAGS_SKIP_HARP_INTRO) {
+        return AUDIOAPI_CACHE_PRELOAD;
+    }
+
+    return AUDIOAPI_CACHE_DEFAULT;
+}
+
+static bool IsSameFile(const char* a, const char* b) {
+    while (*a != '\0' && *a == *b) {
+        a++;
+        b++;
+    }
+
+    return *a == *b;
+}
+
+// Memory a loop cache track holds once pinned. The on-use preload reads the
+// whole file into the cache, not just its loop, so this is the file's size.
+// AudioAPI only reports sizes by registering the file, and the cache strategy
+// has to be chosen before the stream registers it, so the sizes come from the
+// build instead (see kFileSizes). 0 if unknown, which keeps the track
+// evictable.
+static u32 GetPinnedBytes(const ostSeqMap* spec) {
+    int i;
+
+    if (!loopCacheEnabled || !IsLoopCacheTrack(spec->key) || (clockWarmEnabled && IsClockCue(spec->key))) {
+        return 0;
+    }
+
+    for (i = 0; kFileSizes[i].file != NULL; ++i) {
+        if (IsSameFile(kFileSizes[i].file, spec->file)) {
+            return kFileSizes[i].size;
+        }
+    }
+
+    return 0;
+}
+
+static void ChargeLoopCache(AudioApiFileInfo2* info2, u32 pinnedBytes) {
+    if (info2->cacheStrategy == AUDIOAPI_CACHE_PRELOAD_ON_USE_NO_EVICT) {
+        loopCacheBudget -= pinnedBytes; // GetCacheStrategy checked it fits
+    }
+}
+
+// An entry listed in kSharedStreamTracks that streams the same file with the
+// same wrapper as an entry that is already bound reuses that stream instead of
+// generating another sequence and resource for identical data; only key and
+// flags differ.
+//
+// Sharing one cseq-built wrapper per (kind, seqIO) across different files is
+// not possible from here. Each stream's file is tied to its instrument in the
+// soundfont AudioAPI generates for it (hence AudioApi_ReplaceSequenceFont
+// below), and AudioApi_CreateStreamedSequence, CreateStreamedBgmEx and
+// CreateStreamedFanfareEx only create that soundfont together with a new
+// wrapper sequence. No cseq_* command refers to a resource, so a template
+// could only be pointed at each stream's soundfont after the stream had
+// already generated its own sequence, which saves nothing.
+static const ostSeqState* FindSharedStream(const ostSeqMap* spec) {
+    int i;
+
+    if (!IsSharedStreamTrack(spec->key)) {
+        return NULL;
+    }
+
+    for (i = 0; i < seqStateCount; ++i) {
+        const ostSeqMap* other = &kSeqs[seqStates[i].spec];
+
+        if (other->kind == spec->kind && other->seqIO == spec->seqIO && other->volumeOffset == spec->volumeOffset &&
+            IsSameFile(other->file, spec->file)) {
+            return &seqStates[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void LoadAndBindStreamedSequence(const ostSeqMap* spec) {
     s32 seqId;
+    u32 trackCount;
+    u32 pinnedBytes = 0;
     AudioApiFileInfo2 info2 = { 0 };
+    const ostSeqState* shared = FindSharedStream(spec);
+    ostSeqState* state;
+    int idx;
     static unsigned char* modPath = NULL;
 
-    if (modPath == NULL) {
-        modPath = recomp_get_mod_file_path();
-    }
+    if (shared != NULL) {
+        seqId = shared->streamId;
+        trackCount = shared->trackCount;
+        info2.resourceId = shared->resourceId;
+    } else {
+        if (modPath == NULL) {
+            modPath = recomp_get_mod_file_path();
+        }
 
-    info2.volumeOffset = spec->volumeOffset;
+        pinnedBytes = GetPinnedBytes(spec);
+        info2.volumeOffset = spec->volumeOffset;
+        info2.cacheStrategy = GetCacheStrategy(spec, pinnedBytes);
 
-    if (spec->kind == STREAM_FANFARE) {
-        seqId = AudioApi_CreateStreamedFanfareEx(&info2, (char*)modPath, spec->file, spec->seqIO);
-    } else {
-        seqId = AudioApi_CreateStreamedBgmEx(&info2, (char*)modPath, spec->file, spec->seqIO);
+        if (spec->kind == STREAM_FANFARE) {
+            seqId = AudioApi_CreateStreamedFanfareEx(&info2, (char*)modPath, (char*)spec->file, spec->seqIO);
+        } else {
+            seqId = AudioApi_CreateStreamedBgmEx(&info2, (char*)modPath, (char*)spec->file, spec->seqIO);
+        }
+        trackCount = info2.trackCount;
     }
 
     if (seqId >= 0) {
         u8 seqFlags = (u8)spec->flags;
 
-        AudioApi_SetSequenceFlags(seqId, seqFlags);
+        if (shared == NULL) {
+            AudioApi_SetSequenceFlags(seqId, seqFlags);
+        }
         AudioApi_ReplaceSequence(spec->key, &gAudioCtx.sequenceTable->entries[seqId]);
         AudioApi_ReplaceSequenceFont(spec->key, 0, AudioApi_GetSequenceFont(seqId, 0));
         AudioApi_SetSequenceFlags(spec->key, seqFlags);
-        spec->replaced = true;
+
+        idx = spec - kSeqs;
+        replacedBits[idx / 32] |= 1u << (idx % 32);
+
+        state = &seqStates[seqStateCount++];
+        state->key = spec->key;
+        state->streamId = seqId;
+        state->flags = seqFlags;
+        state->spec = idx;
+        state->trackCount = (trackCount <= 0xFF) ? trackCount : 0;
+        state->resourceId = info2.resourceId;
+        BuildChannelMap(&state->channels, trackCount, spec->layers, (spec->flags & OST_SEQ_FLAGS_ENEMY) != 0);
+
+        if (shared == NULL) {
+            ChargeLoopCache(&info2, pinnedBytes);
+        }
     }
 }
 
 
-static ostSeqMap* GetSpecBySeqId(s32 seqId) {
+static ostSeqState* GetSpecBySeqId(s32 seqId) {
     int i;
 
-    for (i = 0; i < ARRAY_COUNT(kSeqs); ++i) {
-        if (kSeqs[i].replaced && kSeqs[i].key == seqId) {
-            return &kSeqs[i];
+    for (i = 0; i < seqStateCount; ++i) {
+        if (seqStates[i].key == seqId) {
+            return &seqStates[i];
         }
     }
 
     return NULL;
 }
 
-RECOMP_CALLBACK("magemods_audio_api", AudioApi_Init) void onAudioApiInit() {
-    int i;
+// Warming a track reads a few bytes of its file, which has AudioAPI pull the
+// whole file into its cache for a track cached on use. The read is issued
+// from the game thread and completes on its own message queue, so the audio
+// thread never waits on it; one read is in flight at a time.
+// AudioAPI cannot pin a resource once its stream exists, so a track that has
+// to stay warm is read again every WARM_REREAD_FRAMES to keep it the most
+// recently used file in the cache.
+#define WARM_REREAD_FRAMES 20
+
+static OSMesgQueue warmQueue;
+static OSMesg warmMsg;
+static OSIoMesg warmIoMesg;
+static bool warmBusy;
+static u8 warmBuffer[16] __attribute__((aligned(16)));
+
+// false if the previous read is still in flight; try again next frame.
+static bool WarmSequence(s32 seqId) {
+    ostSeqState* state = GetSpecBySeqId(seqId);
+
+    if (state == NULL) {
+        return true;
+    }
 
-    for (i = 0; i < ARRAY_COUNT(kSeqs); ++i) {
-        LoadAndBindStreamedSequence(&kSeqs[i]);
+    if (warmBusy) {
+        if (osRecvMesg(&warmQueue, NULL, OS_MESG_NOBLOCK) != 0) {
+            return false;
+        }
+        warmBusy = false;
     }
 
-    for (i = 0; i < CROSSFADE_DURATION_TICKS; i++) {
-        fadeInCurve[i] = Math_SinF((f32)i / CROSSFADE_DURATION_TICKS * M_PI * 0.5f);
-        fadeOutCurve[i] = Math_CosF((f32)i / CROSSFADE_DURATION_TICKS * M_PI * 0.5f);
+    if (AudioLoad_Dma(&warmIoMesg, OS_MESG_PRI_NORMAL, OS_READ, AudioApi_GetResourceDevAddr(state->resourceId, 0, 0),
+                      warmBuffer, sizeof(warmBuffer), &warmQueue, MEDIUM_CART, "Warm") == 0) {
+        warmBusy = true;
+        TRACE("W %d", seqId);
     }
 
-    // Set defaults from config on first load
-    unsigned long volIdx = recomp_get_config_u32("remaster_volume");
-    if (volIdx >= ARRAY_COUNT(kRemasterVolumeTable)) {
-        volIdx = 1;
+    return true;
+}
+
+static void LoadLoopCacheTracks(void) {
+    unsigned long budgetIdx = recomp_get_config_u32("loop_cache");
+    int i, j;
+
+    if (budgetIdx >= ARRAY_COUNT(kLoopCacheBudgetTable)) {
+        budgetIdx = 0; // fallback to Off
     }
-    remasterVolumeMax = kRemasterVolumeTable[volIdx];
 
-    activeChannel = (recomp_get_config_u32("default_soundtrack") != 0)
-        ? OST_CHANNEL
-        : REMASTER_CHANNEL;
+    loopCacheEnabled = kLoopCacheBudgetTable[budgetIdx] != 0;
+    loopCacheBudget = kLoopCacheBudgetTable[budgetIdx] * 1024 * 1024;
 
-    enemyBlendAmount = 0.0f;
-    subBlendAmount = 0.0f;
+    if (!loopCacheEnabled) {
+        return;
+    }
+
+    // Bind in priority order so the budget goes to the most valuable tracks.
+    for (i = 0; i < ARRAY_COUNT(kLoopCacheTracks); ++i) {
+        for (j = 0; j < ARRAY_COUNT(kSeqs); ++j) {
+            if (kSeqs[j].key == kLoopCacheTracks[i] && !IsSpecReplaced(&kSeqs[j])) {
+                LoadAndBindStreamedSequence(&kSeqs[j]);
+            }
+        }
+    }
 }
 
-static void ApplyDefaultSoundtrackConfig(void) {
-    // Remaster volume: 0 = "-3 dB", 1 = "0 dB", 2 = "+3 dB"
-    unsigned long volIdx = recomp_get_config_u32("remaster_volume");
-    if (volIdx >= ARRAY_COUNT(kRemasterVolumeTable)) {
-        volIdx = 1; // fallback to 0 dB
+RECOMP_CALLBACK("magemods_audio_api", AudioApi_Init) void onAudioApiInit() {
+    int i;
+
+    // Warm resume: 0 = "Off", 1 = "On"
+    warmResumeEnabled = recomp_get_config_u32("warm_resume") != 0;
+
+    // Preload short cues: 0 = "Off", 1 = "On"
+    preloadCuesEnabled = recomp_get_config_u32("preload_cues") != 0;
+
+    // Event trace: 0 = "Off", 1 = "On"
+    traceEnabled = recomp_get_config_u32("event_trace") != 0;
+    TRACE("I");
+
+    // Retrigger cache: 0 = "Off", 1 = "On"
+    retriggerCacheEnabled = recomp_get_config_u32("retrigger_cache") != 0;
+
+    // Three-day warm-up: 0 = "Off", 1 = "On"
+    clockWarmEnabled = recomp_get_config_u32("clock_warm") != 0;
+    osCreateMesgQueue(&warmQueue, &warmMsg, 1);
+
+    LoadLoopCacheTracks();
+
+    for (i = 0; i < ARRAY_COUNT(kSeqs); ++i) {
+        if (!IsSpecReplaced(&kSeqs[i])) {
+            LoadAndBindStreamedSequence(&kSeqs[i]);
+        }
     }
-    remasterVolumeMax = kRemasterVolumeTable[volIdx];
+
+    InitMixer();
+
+    // Set defaults from config on first load. Nothing else posts commands
+    // until gameplay starts, so init can act as the producer here.
+    PostCommand(OST_CMD_SET_VOLUME, 0, GetRemasterVolume(recomp_get_config_u32("remaster_volume")));
+
+    requestedChannel = GetConfigChannel();
+    PostCommand(OST_CMD_RESET, requestedChannel, 0.0f);
+}
+
+static void ApplyDefaultSoundtrackConfig(void) {
+    PostCommand(OST_CMD_SET_VOLUME, 0, GetRemasterVolume(recomp_get_config_u32("remaster_volume")));
 
     // Reset to default on scene change: 0 = "Off", 1 = "On"
     if (recomp_get_config_u32("reset_on_scene_change") == 0) {
         return;
     }
 
-    int configChannel = (recomp_get_config_u32("default_soundtrack") != 0)
-        ? OST_CHANNEL
-        : REMASTER_CHANNEL;
+    int configChannel = GetConfigChannel();
 
-    if (activeChannel != configChannel) {
-        activeChannel = configChannel;
-        fadeTimer = CROSSFADE_DURATION_TICKS;
-
-        if (activeChannel == REMASTER_CHANNEL) {
-            Notifications_Emit("Ben's RST", "Active:", "REMASTER");
-        } else {
-            Notifications_Emit("Ben's RST", "Active:", "CD OST");
-        }
+    if (requestedChannel != configChannel) {
+        requestedChannel = configChannel;
+        PostCommand(OST_CMD_SET_LAYER, requestedChannel, 0.0f);
+        NotifyActiveChannel(requestedChannel);
     }
 }
 
+static PlayState* playInitState; // for onPlayInitReturn
+
 RECOMP_HOOK("Play_Init") void onPlayInit(GameState* gameState) {
+    playInitState = (PlayState*)gameState;
+    TRACE("P");
     ApplyDefaultSoundtrackConfig();
 }
 
-RECOMP_HOOK("AudioScript_ProcessSequences") void onProcessSequences() {
-    f32 fadeIn, fadeOut;
+// Audio frame load. The synth frame (sequence processing, notes and the
+// stream reads behind them) is timed for the diagnostics overlay, and every
+// frame is logged when the event trace is on. Nothing acts on the load: the
+// mixer cannot make a frame cheaper, since every mapped channel keeps its
+// voice and AudioAPI decodes the whole stream whatever the volumes are.
+#define AUDIO_FRAME_CYCLES (OS_CPU_COUNTER / 60)
+#define AUDIO_LOAD_COEF 0.10f // per frame
+#define SLOW_FRAME_LOAD 0.50f // counted for the overlay
+
+static u32 synthStartTime;
+static f32 audioLoad;            // smoothed fraction of the frame spent in AudioSynth_Update
+static u32 slowFrameCount;       // for diagnostics
+
+RECOMP_HOOK("AudioSynth_Update") void onSynthUpdate(Acmd* abiCmdStart, s32* numAbiCmds, s16* aiBufStart,
+                                                   s32 numSamplesPerFrame) {
+    synthStartTime = (u32)osGetTime();
+}
 
-    if (fadeTimer > 0) {
-        fadeIn = fadeInCurve[CROSSFADE_DURATION_TICKS - fadeTimer];
-        fadeOut = fadeOutCurve[CROSSFADE_DURATION_TICKS - fadeTimer];
-        fadeTimer--;
-    } else {
-        fadeIn = 1.0f;
-        fadeOut = 0.0f;
-    }
+RECOMP_HOOK_RETURN("AudioSynth_Update") void onSynthUpdateReturn(void) {
+    // 32-bit cycle delta: wraps only after ~90 s, far beyond one frame.
+    u32 elapsed = (u32)osGetTime() - synthStartTime;
+    f32 load = (f32)(s32)elapsed / AUDIO_FRAME_CYCLES;
 
-    if (activeChannel == REMASTER_CHANNEL) {
-        remasterVolumeUnducked = fadeIn * remasterVolumeMax;
-        ostVolumeUnducked = fadeOut * OST_VOLUME;
-        remasterVolumeSub = remasterVolumeMax;
-        ostVolumeSub = 0.0f;
-    } else {
-        remasterVolumeUnducked = fadeOut * remasterVolumeMax;
-        ostVolumeUnducked = fadeIn * OST_VOLUME;
-        remasterVolumeSub = 0.0f;
-        ostVolumeSub = OST_VOLUME;
+    audioLoad += (load - audioLoad) * AUDIO_LOAD_COEF;
+
+    if (load > SLOW_FRAME_LOAD) {
+        slowFrameCount++;
     }
 
-    // Treat enemy and non-enemy sub-BGM blend intents with independent curves.
-    // Enemy blend ducks a bit more aggressively than ambient/spatial sub-BGM.
-    f32 enemyDuck = 1.0f - (enemyBlendAmount * enemyBlendAmount) * 0.20f;
-    f32 subDuck = 1.0f - subBlendAmount * 0.12f;
-    f32 bgmDuck = CLAMP(enemyDuck * subDuck, 0.0f, 1.0f);
+    TRACE("F %d", (s32)(load * 1000.0f));
+}
+
+// With the trace on, each audio tick and each replaced player's processing
+// within it is timed as well, so a profile shows which part of a slow frame
+// the sequence processing took. Logged as nanoseconds, the player's from the
+// start of its tick.
+static u32 tickStartTime;
+static u32 playerStartTime;
+static s32 processingPlayer;
 
-    remasterVolume = remasterVolumeUnducked * bgmDuck;
-    ostVolume = ostVolumeUnducked * bgmDuck;
+RECOMP_HOOK("AudioScript_ProcessSequences") void onProcessSequences() {
+    if (traceEnabled) {
+        tickStartTime = (u32)osGetTime();
+    }
+
+    audioTick++;
+    DrainCommands();
+    StepMixer();
 
     // Keep both BGM players fully unmasked for interleaved multi-track mixes.
     ResetBgmChannelDisableMasks();
 }
 
+RECOMP_HOOK_RETURN("AudioScript_ProcessSequences") void onProcessSequencesReturn(void) {
+    TRACE("K %u", (u32)OS_CYCLES_TO_NSEC((u32)osGetTime() - tickStartTime));
+}
+
 RECOMP_CALLBACK("magemods_audio_api", AudioApi_EnemyBgmSplit) void onEnemyBgmSplit(s8 volumeSplit) {
-    enemyBlendAmount = CLAMP((f32)volumeSplit / 127.0f, 0.0f, 1.0f);
-    subBlendAmount = 0.0f;
+    TRACE("E %d", volumeSplit);
+    PostCommand(OST_CMD_SET_BLEND, BLEND_SOURCE_ENEMY, volumeSplit);
+    PostCommand(OST_CMD_SET_BLEND, BLEND_SOURCE_SUB, 0.0f);
     ResetBgmChannelDisableMasks();
 }
 
 RECOMP_CALLBACK("magemods_audio_api", AudioApi_SubBgmBlend) void onSubBgmBlend(s8 volumeSplit) {
-    subBlendAmount = CLAMP((f32)volumeSplit / 127.0f, 0.0f, 1.0f);
-    if (subBlendAmount > 0.0f) {
-        enemyBlendAmount = 0.0f;
-    }
+    TRACE("U %d", volumeSplit);
+    PostCommand(OST_CMD_SET_BLEND, BLEND_SOURCE_SUB, volumeSplit);
     ResetBgmChannelDisableMasks();
 }
 
 RECOMP_CALLBACK("magemods_audio_api", AudioApi_BgmBlendIntent) void onBgmBlendIntent(AudioApiBgmBlendSource source, s8 volumeSplit) {
-    f32 amount = CLAMP((f32)volumeSplit / 127.0f, 0.0f, 1.0f);
+    TRACE("B %d %d", source, volumeSplit);
 
     switch (source) {
         case AUDIOAPI_BGM_BLEND_SOURCE_ENEMY:
-            enemyBlendAmount = amount;
-            if (amount > 0.0f) {
-                subBlendAmount = 0.0f;
-            }
+            PostCommand(OST_CMD_SET_BLEND, BLEND_SOURCE_ENEMY, volumeSplit);
             break;
 
         case AUDIOAPI_BGM_BLEND_SOURCE_SUB_SPATIAL:
         case AUDIOAPI_BGM_BLEND_SOURCE_SUB_NONSPATIAL:
-            subBlendAmount = amount;
-            if (amount > 0.0f) {
-                enemyBlendAmount = 0.0f;
-            }
+            PostCommand(OST_CMD_SET_BLEND, BLEND_SOURCE_SUB, volumeSplit);
             break;
     }
 
     ResetBgmChannelDisableMasks();
 }
 
-RECOMP_HOOK("AudioScript_SequencePlayerProcessSound") void onSequencePlayerProcessSound(SequencePlayer* seqPlayer) {
-    s32 seqId;
-    ostSeqMap* spec;
-    SequenceChannel* channel;
+// What the last lookup for each sequence player resolved to, so the cross-mod
+// lookups run once per sequence start instead of every tick. A new sequence
+// shows up as new sequence data; a restart of the same one reuses its data,
+// so the sequence start hooks below drop the entry instead.
+typedef struct {
+    u8* seqData;
+    u8 seqId;
+    ostSeqState* spec;
+    u16 liveMask;       // channels the last tick played: active and outgoing layer, stem
+} ostPlayerCache;
+
+static ostPlayerCache playerCache[SEQ_PLAYER_MAX];
+
+static ostSeqState* GetPlayerSpec(SequencePlayer* seqPlayer) {
+    ostPlayerCache* cache = &playerCache[seqPlayer->playerIndex];
+
+    if (cache->seqData != seqPlayer->seqData || cache->seqId != seqPlayer->seqId) {
+        cache->seqData = seqPlayer->seqData;
+        cache->seqId = seqPlayer->seqId;
+        cache->spec = GetSpecBySeqId(AudioApi_GetSeqPlayerSeqId(seqPlayer));
+        TRACE("S %d %d %d", seqPlayer->playerIndex, seqPlayer->seqId, (cache->spec != NULL) ? cache->spec->key : -1);
+    }
+
+    return cache->spec;
+}
+
+// Every sequence start, including the same sequence starting over (a retried
+// mini-game, a boss re-aggro, walking back into an area). A restart reuses the
+// sequence data, so without this the next tick would not resolve the player
+// again.
+static void InvalidatePlayerCache(s32 playerIndex) {
+    if (playerIndex >= 0 && playerIndex < SEQ_PLAYER_MAX) {
+        playerCache[playerIndex].seqData = NULL;
+    }
+}
+
+RECOMP_HOOK("AudioLoad_SyncInitSeqPlayer") void onSyncInitSeqPlayer(s32 playerIndex, s32 seqId, s32 arg2) {
+    InvalidatePlayerCache(playerIndex);
+}
+
+RECOMP_HOOK("AudioLoad_SyncInitSeqPlayerSkipTicks") void onSyncInitSeqPlayerSkipTicks(s32 playerIndex, s32 seqId,
+                                                                                       s32 skipTicks) {
+    InvalidatePlayerCache(playerIndex);
+}
+
+static void SetChannelVolume(SequenceChannel* channel, f32 volume) {
+    if (channel->volume != volume) {
+        channel->volume = volume;
+        channel->changes.s.volume = true;
+    }
+}
+
+static void EnforceStereoLayout(SequenceChannel* channel, bool isLeft) {
     SequenceLayer* layer0;
     SequenceLayer* layer1;
-    f32 volume;
-    bool enforceStereoLayout;
     s32 desiredPan;
+
+    channel->muted = false;
+
+    layer0 = channel->layers[0];
+    layer1 = channel->layers[1];
+
+    if (layer0 != NULL && layer1 != NULL && layer0 != NO_LAYER && layer1 != NO_LAYER) {
+        channel->pan = 64;
+        channel->newPan = 64;
+        channel->panChannelWeight = 0;
+        channel->changes.s.pan = true;
+
+        layer0->notePan = 0;
+        layer0->pan = 0;
+        layer1->notePan = 127;
+        layer1->pan = 127;
+    } else {
+        desiredPan = isLeft ? 0 : 127;
+        channel->pan = desiredPan;
+        channel->newPan = desiredPan;
+        channel->panChannelWeight = 127;
+        channel->changes.s.pan = true;
+    }
+}
+
+RECOMP_HOOK("AudioScript_SequencePlayerProcessSound") void onSequencePlayerProcessSound(SequencePlayer* seqPlayer) {
+    ostSeqState* spec;
+    ostChannelMap* map;
+    SequenceChannel* channel;
+    bool enforceStereoLayout;
+    f32 volumes[SEQ_CHANNEL_COUNT];
+    u32 liveMask;
+    u32 mask;
     int i;
 
-    seqId = AudioApi_GetSeqPlayerSeqId(seqPlayer);
-    spec = GetSpecBySeqId(seqId);
-    enforceStereoLayout = (seqId >= 0) && ((AudioApi_GetSequenceFlags(seqId) & SEQ_FLAG_ENEMY) != 0);
+    if (traceEnabled) {
+        playerStartTime = (u32)osGetTime();
+        processingPlayer = seqPlayer->playerIndex;
+    }
 
-    if (spec) {
-        for (i = 0; i < ARRAY_COUNT(seqPlayer->channels); i++) {
-            channel = seqPlayer->channels[i];
-            if (channel == NULL) {
-                continue;
-            }
+    spec = GetPlayerSpec(seqPlayer);
+    if (spec == NULL) {
+        return;
+    }
 
-            // One channel per audio track: channels are laid out as stereo pairs.
-            // Pair 0 (ch 0/1) = remaster, pair 1 (ch 2/3) = OST, alternating thereafter.
-            volume = (((i / 2) % 2) == REMASTER_CHANNEL)
-                ? remasterVolumeSub
-                : ostVolumeSub;
+    map = &spec->channels;
+
+    // Same flags LoadAndBindStreamedSequence handed to AudioApi_SetSequenceFlags.
+    enforceStereoLayout = (spec->flags & OST_SEQ_FLAGS_ENEMY) != 0;
+
+    // Live pairs keep their voices even when one is silent: each channel
+    // plays its own stream note, and releasing it would lose its sample
+    // position, so the layers would drift apart on the next crossfade.
+    // Folding the pairs into one voice has to happen in AudioAPI's decoder.
+    liveMask = GetChannelVolumes(map, seqPlayer->playerIndex == SEQ_PLAYER_BGM_MAIN, volumes);
+
+    // Every mapped channel is written every tick, idle layers included: the
+    // wrapper's script and the game's channel volume commands can raise a
+    // parked channel at any time. SetChannelVolume only writes a volume that
+    // differs.
+    for (mask = GetMappedChannels(map), i = 0; mask != 0; mask >>= 1, i++) {
+        channel = seqPlayer->channels[i];
+        if (!(mask & 1) || channel == NULL) {
+            continue;
+        }
 
-            if (seqPlayer->playerIndex == SEQ_PLAYER_BGM_MAIN) {
-                volume = (((i / 2) % 2) == REMASTER_CHANNEL)
-                    ? remasterVolume
-                    : ostVolume;
-            }
+        SetChannelVolume(channel, volumes[i]);
 
-            if (channel->volume != volume) {
-                channel->volume = volume;
-                channel->changes.s.volume = true;
-            }
+        if (enforceStereoLayout && ((liveMask >> i) & 1)) {
+            EnforceStereoLayout(channel, (map->leftMask >> i) & 1);
+        }
+    }
 
-            if (!enforceStereoLayout) {
-                continue;
-            }
+    playerCache[seqPlayer->playerIndex].liveMask = liveMask;
+}
+
+RECOMP_HOOK_RETURN("AudioScript_SequencePlayerProcessSound") void onSequencePlayerProcessSoundReturn(void) {
+    u32 now;
 
-            channel->muted = false;
+    if (!traceEnabled || playerCache[processingPlayer].spec == NULL) {
+        return;
+    }
 
-            layer0 = channel->layers[0];
-            layer1 = channel->layers[1];
+    now = (u32)osGetTime();
+    TRACE("Q %d %u %u", processingPlayer, (u32)OS_CYCLES_TO_NSEC(playerStartTime - tickStartTime),
+          (u32)OS_CYCLES_TO_NSEC(now - playerStartTime));
+}
 
-            if (layer0 != NULL && layer1 != NULL && layer0 != NO_LAYER && layer1 != NO_LAYER) {
-                channel->pan = 64;
-                channel->newPan = 64;
-                channel->panChannelWeight = 0;
-                channel->changes.s.pan = true;
+// -----------------------------------------------------------------------------
+// Diagnostics overlay
+//
+// A small recompui panel showing what the mixer is doing. It reads the audio
+// thread's state without synchronisation, which is fine for a readout, and
+// only rebuilds its text every DIAG_REFRESH_FRAMES frames.
+
+#define DIAG_REFRESH_FRAMES 10
+#define DIAG_LINE_COUNT (3 + ARRAY_COUNT(seqPlayers))
+#define DIAG_LINE_LENGTH 96
+
+static const char* const kPlayerNames[] = {
+    "Main",    // SEQ_PLAYER_BGM_MAIN
+    "Fanfare", // SEQ_PLAYER_FANFARE
+    "SFX",     // SEQ_PLAYER_SFX
+    "Sub",     // SEQ_PLAYER_BGM_SUB
+    "Ambience" // SEQ_PLAYER_AMBIENCE
+};
 
-                layer0->notePan = 0;
-                layer0->pan = 0;
-                layer1->notePan = 127;
-                layer1->pan = 127;
+static RecompuiContext diagContext = RECOMPUI_NULL_CONTEXT;
+static RecompuiResource diagLines[DIAG_LINE_COUNT];
+static bool diagVisible;
+static int diagFrames;
+
+static char* AppendText(char* dst, char* end, const char* text) {
+    while (*text != '\0' && dst < end - 1) {
+        *dst++ = *text++;
+    }
+    *dst = '\0';
+
+    return dst;
+}
+
+static char* AppendNumber(char* dst, char* end, u32 value) {
+    char digits[10];
+    int count = 0;
+
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+
+    while (count > 0 && dst < end - 1) {
+        *dst++ = digits[--count];
+    }
+    *dst = '\0';
+
+    return dst;
+}
+
+static char* AppendPercent(char* dst, char* end, f32 value) {
+    dst = AppendNumber(dst, end, (value > 0.0f) ? (u32)(value * 100.0f + 0.5f) : 0);
+
+    return AppendText(dst, end, "%");
+}
+
+static u32 CountChannels(u32 mask) {
+    u32 count = 0;
+
+    for (; mask != 0; mask >>= 1) {
+        count += mask & 1;
+    }
+
+    return count;
+}
+
+static void CreateDiagnosticsOverlay(void) {
+    static const RecompuiColor background = { 0, 0, 0, 160 };
+    static const RecompuiColor text = { 255, 255, 255, 255 };
+    RecompuiResource panel;
+    int i;
+
+    diagContext = recompui_create_context();
+    recompui_open_context(diagContext);
+    recompui_set_context_captures_input(diagContext, 0);
+    recompui_set_context_captures_mouse(diagContext, 0);
+
+    panel = recompui_create_element(diagContext, recompui_context_root(diagContext));
+    recompui_set_position(panel, POSITION_ABSOLUTE);
+    recompui_set_left(panel, 16.0f, UNIT_DP);
+    recompui_set_top(panel, 16.0f, UNIT_DP);
+    recompui_set_padding(panel, 8.0f, UNIT_DP);
+    recompui_set_border_radius(panel, 4.0f, UNIT_DP);
+    recompui_set_background_color(panel, &background);
+    recompui_set_display(panel, DISPLAY_FLEX);
+    recompui_set_flex_direction(panel, FLEX_DIRECTION_COLUMN);
+
+    for (i = 0; i < DIAG_LINE_COUNT; i++) {
+        diagLines[i] = recompui_create_label(diagContext, panel, "", LABELSTYLE_SMALL);
+        recompui_set_color(diagLines[i], &text);
+    }
+
+    recompui_close_context(diagContext);
+}
+
+static void UpdateDiagnosticsOverlay(void) {
+    char line[DIAG_LINE_LENGTH];
+    char* end = line + sizeof(line);
+    char* p;
+    int layer;
+    int i;
+    // Diagnostics overlay: 0 = "Off", 1 = "On"
+    bool enabled = recomp_get_config_u32("diagnostics_overlay") != 0;
+
+    if (enabled != diagVisible) {
+        if (enabled && diagContext == RECOMPUI_NULL_CONTEXT) {
+            CreateDiagnosticsOverlay();
+        }
+        if (diagContext != RECOMPUI_NULL_CONTEXT) {
+            if (enabled) {
+                recompui_show_context(diagContext);
             } else {
-                desiredPan = (i % 2) == 0 ? 0 : 127;
-                channel->pan = desiredPan;
-                channel->newPan = desiredPan;
-                channel->panChannelWeight = 127;
-                channel->changes.s.pan = true;
+                recompui_hide_context(diagContext);
+            }
+        }
+        diagVisible = enabled;
+        diagFrames = 0;
+    }
+
+    if (!diagVisible || diagFrames-- > 0) {
+        return;
+    }
+    diagFrames = DIAG_REFRESH_FRAMES;
+
+    recompui_open_context(diagContext);
+
+    p = AppendText(line, end, "Layer: ");
+    p = AppendText(p, end, kLayerNames[(mix.activeChannel >= 0) ? mix.activeChannel : REMASTER_CHANNEL]);
+    p = AppendText(p, end, "  crossfade ");
+    AppendPercent(p, end, (mix.fadeTimer > 0) ? 1.0f - (f32)mix.fadeTimer / CROSSFADE_DURATION_TICKS : 1.0f);
+    recompui_set_text(diagLines[0], line);
+
+    p = line;
+    for (layer = 0; layer < ARRAY_COUNT(kLayerNames); layer++) {
+        p = AppendText(p, end, kLayerNames[layer]);
+        p = AppendText(p, end, " ");
+        p = AppendPercent(p, end, GetLayerGain(layer));
+        p = AppendText(p, end, "  ");
+    }
+    p = AppendText(p, end, "duck ");
+    p = AppendPercent(p, end, mix.bgmDuck);
+    p = AppendText(p, end, "  stem ");
+    p = AppendPercent(p, end, mix.stemVolume);
+    p = AppendText(p, end, "  enemy ");
+    p = AppendNumber(p, end, mix.blendAmounts[BLEND_SOURCE_ENEMY]);
+    p = AppendText(p, end, "  sub ");
+    AppendNumber(p, end, mix.blendAmounts[BLEND_SOURCE_SUB]);
+    recompui_set_text(diagLines[1], line);
+
+    p = AppendText(line, end, "Audio frame ");
+    p = AppendPercent(p, end, audioLoad);
+    p = AppendText(p, end, "  slow frames ");
+    AppendNumber(p, end, slowFrameCount);
+    recompui_set_text(diagLines[2], line);
+
+    for (i = 0; i < ARRAY_COUNT(seqPlayers); i++) {
+        ostPlayerCache* cache = &playerCache[seqPlayers[i]];
+
+        p = AppendText(line, end, kPlayerNames[seqPlayers[i]]);
+        p = AppendText(p, end, ": ");
+        if (!gAudioCtx.seqPlayers[seqPlayers[i]].enabled) {
+            AppendText(p, end, "-");
+        } else {
+            p = AppendText(p, end, "seq ");
+            p = AppendNumber(p, end, cache->seqId);
+            if (cache->spec != NULL) {
+                p = AppendText(p, end, "  ");
+                p = AppendText(p, end, kSeqs[cache->spec->spec].file);
+                p = AppendText(p, end, "  ");
+                p = AppendNumber(p, end, CountChannels(cache->liveMask));
+                AppendText(p, end, " live ch");
             }
         }
+        recompui_set_text(diagLines[3 + i], line);
+    }
+
+    recompui_close_context(diagContext);
+}
+
+// Three-day warm-up. The clock is checked every frame but the plan only
+// changes on the hour: the track wanted is the Clock Town cue due by the end
+// of the next hour, read again until it starts. AudioAPI cannot drop a
+// resource either, so the previous day's theme is released by no longer
+// touching it; the clock tracks are cached on use and evictable (see
+// GetCacheStrategy), so the cache reclaims it.
+#define WARM_LEAD_HOURS 1
+
+static s32 clockWarmKey = -1; // kClockCues key being warmed, -1 for none
+
+static s32 FindClockCue(void) {
+    u32 hour = (u32)gSaveContext.save.time * 24 / 0x10000;
+    s32 cycleHour;
+    int i;
+
+    if (CURRENT_DAY < 1 || CURRENT_DAY > 3) {
+        return -1;
+    }
+
+    // The day number turns over at dawn, so count hours from 6:00.
+    cycleHour = (CURRENT_DAY - 1) * 24 + (hour + 18) % 24;
+
+    for (i = 0; i < ARRAY_COUNT(kClockCues); ++i) {
+        if (cycleHour >= kClockCues[i].dueHour - WARM_LEAD_HOURS && cycleHour <= kClockCues[i].dueHour) {
+            return kClockCues[i].key;
+        }
+    }
+
+    return -1;
+}
+
+static void UpdateClockWarm(void) {
+    static u32 lastHour = ~0u;
+    static s32 lastDay = -1;
+    static int frames;
+    u32 hour = (u32)gSaveContext.save.time * 24 / 0x10000;
+
+    if (!clockWarmEnabled) {
+        return;
+    }
+
+    if (hour != lastHour || CURRENT_DAY != lastDay) {
+        s32 key = FindClockCue();
+
+        lastHour = hour;
+        lastDay = CURRENT_DAY;
+
+        // A cue that already started is not picked up again within its hour.
+        if (key >= 0 && AudioApi_IsSequencePlaying(key)) {
+            key = -1;
+        }
+        if (key != clockWarmKey) {
+            clockWarmKey = key;
+            frames = 0;
+        }
     }
 
+    if (clockWarmKey < 0 || frames-- > 0) {
+        return;
+    }
+    frames = WARM_REREAD_FRAMES;
+
+    // Playing: from here the track holds its own place in the cache.
+    if (AudioApi_IsSequencePlaying(clockWarmKey)) {
+        clockWarmKey = -1;
+        return;
+    }
+
+    if (!WarmSequence(clockWarmKey)) {
+        frames = 0;
+    }
+}
+
+// Session warm-up: while the rehearsal room is loaded, the session pieces are
+// read one per frame, then the round starts over after WARM_REREAD_FRAMES.
+static bool inRehearsalRoom;
+
+RECOMP_HOOK_RETURN("Play_Init") void onPlayInitReturn(void) {
+    inRehearsalRoom = playInitState != NULL && playInitState->sceneId == SCENE_BANDROOM;
+}
+
+static void UpdateSessionWarm(void) {
+    static int next;
+    static int frames;
+
+    if (!preloadCuesEnabled || !inRehearsalRoom || frames-- > 0) {
+        return;
+    }
+
+    if (WarmSequence(kSessionCues[next])) {
+        next = (next + 1) % ARRAY_COUNT(kSessionCues);
+        frames = (next == 0) ? WARM_REREAD_FRAMES : 0;
+    }
 }
 
 RECOMP_HOOK("Graph_ExecuteAndDraw") void onGraphExecuteAndDraw(GraphicsContext* gfxCtx, GameState* gameState) {
     // Quick switch with L: 0 = "On", 1 = "Off"
     if (recomp_get_config_u32("quick_switch_l") == 0 &&
         CHECK_BTN_ALL(CONTROLLER1(gameState)->press.button, BTN_L)) {
-        activeChannel = (activeChannel + 1) % 2;
-        fadeTimer = CROSSFADE_DURATION_TICKS;
-
-        if (activeChannel == REMASTER_CHANNEL) {
-            Notifications_Emit("Ben's RST", "Active:", "REMASTER");
-        } else {
-            Notifications_Emit("Ben's RST", "Active:", "CD OST");
-        }
+        // Post the resulting layer rather than a toggle, so a toggle can
+        // never be applied twice or lost against a concurrent reset.
+        requestedChannel = (requestedChannel + 1) % ARRAY_COUNT(kLayerNames);
+        TRACE("L %d", requestedChannel);
+        PostCommand(OST_CMD_SET_LAYER, requestedChannel, 0.0f);
+        NotifyActiveChannel(requestedChannel);
     }
 
+    UpdateClockWarm();
+    UpdateSessionWarm();
+    UpdateDiagnosticsOverlay();
 }
@@ -0,0 +1,150 @@
+// Host-side driver for the mod's mixer, shared by trace_replay.c and
+// render_mix.c. The mixing rules themselves come from src/mixer.h, the same
+// file the mod runs; this adds what only the tools need: reading an event
+// trace and feeding its events to the mixer in the order the mod sees them.
+//
+// Single-header, static functions only; include it from one file per tool.
+
+#ifndef MIX_MODEL_H
+#define MIX_MODEL_H
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MIXER_SINF sinf
+#define MIXER_COSF cosf
+#include "../src/mixer.h"
+
+// Heap check. In the mod, ApplyCommand, StepMixer and GetChannelVolumes run on
+// the audio thread, where a heap call would stall the tick. On glibc the tools
+// replace the allocator for the whole program, and any malloc, calloc,
+// realloc or free made between BeginTick and EndTick aborts the run, so every
+// replay and render also checks that the mixer never allocates. Other C
+// libraries build without the check. The flag is volatile: the compiler
+// assumes the builtin allocator reads no program state, and would otherwise
+// drop the stores around a call it can see.
+static volatile int inTick;
+
+static void BeginTick(void) {
+    inTick = 1;
+}
+
+static void EndTick(void) {
+    inTick = 0;
+}
+
+#if defined(__GLIBC__)
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+
+static void HeapFault(const char* call) {
+    inTick = 0; // stderr must not trip the check again
+    fprintf(stderr, "heap check: %s during a simulated audio tick\n", call);
+    abort();
+}
+
+void* malloc(size_t size) {
+    if (inTick) {
+        HeapFault("malloc");
+    }
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    if (inTick) {
+        HeapFault("calloc");
+    }
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (inTick) {
+        HeapFault("realloc");
+    }
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    if (inTick && ptr != NULL) {
+        HeapFault("free");
+    }
+    __libc_free(ptr);
+}
+#endif
+
+typedef struct {
+    unsigned long tick;
+    unsigned long order; // position in the log, keeps same-tick events stable
+    char type;
+    int args[3];
+} Event;
+
+// The events that change the mixer, applied at the top of the tick they are
+// stamped with, where onProcessSequences drains the commands. Everything else in a trace (inputs, blend callbacks, sequence starts) is
+// only a marker; what the mixer made of it shows up as a command.
+static void ApplyTickEvent(const Event* e) {
+    switch (e->type) {
+        case 'C':
+            ApplyCommand(e->args[0], e->args[1], e->args[2] / 1000.0f);
+            break;
+    }
+}
+
+static int CompareEvents(const void* a, const void* b) {
+    const Event* ea = a;
+    const Event* eb = b;
+
+    if (ea->tick != eb->tick) {
+        return (ea->tick < eb->tick) ? -1 : 1;
+    }
+    return (ea->order < eb->order) ? -1 : (ea->order > eb->order);
+}
+
+static size_t LoadTrace(const char* path, Event** out) {
+    FILE* f = fopen(path, "r");
+    char line[512];
+    size_t count = 0, capacity = 1024;
+    Event* events = malloc(capacity * sizeof(Event));
+
+    if (f == NULL || events == NULL) {
+        fprintf(stderr, "cannot read trace %s\n", path);
+        exit(1);
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        // The mod's lines may sit in a log with other output and prefixes.
+        const char* p = strstr(line, "RST ");
+        Event e;
+
+        if (p == NULL) {
+            continue;
+        }
+
+        memset(&e, 0, sizeof(e));
+        if (sscanf(p, "RST %lu %c %d %d %d", &e.tick, &e.type, &e.args[0], &e.args[1], &e.args[2]) < 2) {
+            continue;
+        }
+        e.order = count;
+
+        if (count == capacity) {
+            capacity *= 2;
+            events = realloc(events, capacity * sizeof(Event));
+            if (events == NULL) {
+                fprintf(stderr, "out of memory reading %s\n", path);
+                exit(1);
+            }
+        }
+        events[count++] = e;
+    }
+    fclose(f);
+
+    qsort(events, count, sizeof(Event), CompareEvents);
+    *out = events;
+    return count;
+}
+
+#endif // MIX_MODEL_H
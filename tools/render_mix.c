@@ -0,0 +1,354 @@
+// Headless renderer for the mod's mixing rules.
+//
+// Plays one track of the audio/ pack through the same gain logic as
+// src/soundtrack.c (layer crossfade, remaster volume option, per-track offset,
+// blend ducking and enemy stems) and writes the main BGM player's output as a
+// 16-bit stereo WAV, so a gain change can be heard and diffed before it ships:
+//
+//   render_mix <track.ogg> <out.wav> [options]
+//     --script <log.txt>   timeline of "RST <tick> <event> <args>" lines, in
+//                          the event trace format (see trace_replay.c)
+//     --layers <n>         stereo pairs that are layers, kSeqs .layers (2)
+//     --enemy              track has OST_SEQ_FLAGS_ENEMY (a spare pair is a stem)
+//     --offset <n>         kSeqs .volumeOffset, in dB (0)
+//     --layer <n>          layer selected at the start (0, remaster)
+//     --volume <0|1|2>     "Remaster Volume" option, GetRemasterVolume (1)
+//     --seconds <s>        length to render (end of script or of the track)
+//
+// A script for a crossfade to the CD OST at one second, an enemy fight from
+// three to five seconds (OST_CMD_SET_BLEND on the enemy source), and back to
+// the remaster at six:
+//
+//   RST 180 C 0 1 0
+//   RST 540 C 3 0 127000
+//   RST 900 C 3 0 0
+//   RST 1080 C 0 0 0
+//
+// Every stage is timed on its own (decode, mixer model, gain application,
+// WAV write) and reported on stderr with the peak level and clipped samples.
+//
+// Channel gains are squared on the way to the output, as the game does when
+// it turns channel volume into applied volume, and ramp linearly across each
+// tick like the synth's volume ramps. Loop points come from the LOOPSTART and
+// LOOPEND / LOOPLENGTH comments; untagged tracks play once.
+
+#include <stdint.h>
+#include <time.h>
+#include <vorbis/vorbisfile.h>
+
+#include "mix_model.h"
+
+#define TICKS_PER_SECOND CROSSFADE_DURATION_TICKS // the crossfade is one second
+
+typedef struct {
+    int16_t* samples; // interleaved
+    int channels;
+    long sampleRate;
+    long frames;
+    long loopStart; // -1 if the track does not loop
+    long loopEnd;
+} Track;
+
+static void Die(const char* msg, const char* arg) {
+    fprintf(stderr, "render_mix: %s%s%s\n", msg, arg ? ": " : "", arg ? arg : "");
+    exit(1);
+}
+
+static double Now(void) {
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static long GetTag(vorbis_comment* vc, const char* tag) {
+    char* value = vorbis_comment_query(vc, tag, 0);
+
+    return (value != NULL) ? atol(value) : -1;
+}
+
+static void LoadTrack(const char* path, Track* track) {
+    OggVorbis_File vf;
+    vorbis_info* vi;
+    vorbis_comment* vc;
+    size_t capacity;
+    size_t used = 0;
+    long loopLength;
+    int section;
+    long got;
+
+    if (ov_fopen(path, &vf) != 0) {
+        Die("cannot open Ogg Vorbis file", path);
+    }
+
+    vi = ov_info(&vf, -1);
+    vc = ov_comment(&vf, -1);
+    track->channels = vi->channels;
+    track->sampleRate = vi->rate;
+    track->loopStart = GetTag(vc, "LOOPSTART");
+    track->loopEnd = GetTag(vc, "LOOPEND");
+    loopLength = GetTag(vc, "LOOPLENGTH");
+    if (track->loopEnd < 0 && track->loopStart >= 0 && loopLength > 0) {
+        track->loopEnd = track->loopStart + loopLength;
+    }
+
+    capacity = (size_t)ov_pcm_total(&vf, -1) * track->channels + 4096;
+    track->samples = malloc(capacity * sizeof(int16_t));
+    if (track->samples == NULL) {
+        Die("out of memory", path);
+    }
+
+    for (;;) {
+        if (capacity - used < 4096) {
+            capacity *= 2;
+            track->samples = realloc(track->samples, capacity * sizeof(int16_t));
+            if (track->samples == NULL) {
+                Die("out of memory", path);
+            }
+        }
+        got = ov_read(&vf, (char*)(track->samples + used), (int)((capacity - used) * sizeof(int16_t)), 0, 2, 1,
+                      &section);
+        if (got <= 0) {
+            break;
+        }
+        used += got / sizeof(int16_t);
+    }
+
+    ov_clear(&vf);
+    track->frames = used / track->channels;
+
+    if (track->loopEnd < 0 || track->loopEnd > track->frames) {
+        track->loopEnd = track->frames;
+    }
+    if (track->loopStart >= track->loopEnd) {
+        track->loopStart = -1;
+    }
+}
+
+// Channel volumes onSequencePlayerProcessSound writes to the main BGM player,
+// squared into the amplitude the synth applies.
+static void GetChannelGains(const ostChannelMap* map, float offset, float* gains, int channels) {
+    float volumes[SEQ_CHANNEL_COUNT];
+    int i;
+
+    GetChannelVolumes(map, 1, volumes);
+
+    for (i = 0; i < channels; i++) {
+        float volume = (i < SEQ_CHANNEL_COUNT) ? volumes[i] : 0.0f;
+
+        gains[i] = volume * volume * offset;
+    }
+}
+
+static void WriteLe(FILE* f, uint32_t v, int bytes) {
+    int i;
+
+    for (i = 0; i < bytes; i++) {
+        fputc((v >> (i * 8)) & 0xFF, f);
+    }
+}
+
+static void WriteWav(const char* path, const int16_t* samples, long frames, long sampleRate) {
+    FILE* f = fopen(path, "wb");
+    uint32_t dataBytes = (uint32_t)frames * 2 * sizeof(int16_t);
+    long i;
+
+    if (f == NULL) {
+        Die("cannot write", path);
+    }
+
+    fwrite("RIFF", 1, 4, f);
+    WriteLe(f, 36 + dataBytes, 4);
+    fwrite("WAVEfmt ", 1, 8, f);
+    WriteLe(f, 16, 4);
+    WriteLe(f, 1, 2); // PCM
+    WriteLe(f, 2, 2);
+    WriteLe(f, (uint32_t)sampleRate, 4);
+    WriteLe(f, (uint32_t)sampleRate * 2 * sizeof(int16_t), 4);
+    WriteLe(f, 2 * sizeof(int16_t), 2);
+    WriteLe(f, 16, 2);
+    fwrite("data", 1, 4, f);
+    WriteLe(f, dataBytes, 4);
+
+    for (i = 0; i < frames * 2; i++) {
+        WriteLe(f, (uint16_t)samples[i], 2);
+    }
+
+    if (fclose(f) != 0) {
+        Die("cannot write", path);
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* scriptPath = NULL;
+    int layers = 2;
+    int enemy = 0;
+    int startLayer = 0;
+    int volumeIndex = 1;
+    double offsetDb = 0.0;
+    double seconds = 0.0;
+    Event* events = NULL;
+    size_t count = 0;
+    size_t next = 0;
+    Track track;
+    ostChannelMap map;
+    float offset;
+    float* gains;
+    int16_t* out;
+    long ticks, tick, frames, frame, pos;
+    long clipped = 0;
+    int peak = 0;
+    double start, decodeTime, modelTime, mixTime, writeTime;
+    int arg;
+    int i;
+
+    for (arg = 3; arg < argc; arg++) {
+        if (strcmp(argv[arg], "--enemy") == 0) {
+            enemy = 1;
+        } else if (arg + 1 >= argc) {
+            break;
+        } else if (strcmp(argv[arg], "--script") == 0) {
+            scriptPath = argv[++arg];
+        } else if (strcmp(argv[arg], "--layers") == 0) {
+            layers = atoi(argv[++arg]);
+        } else if (strcmp(argv[arg], "--offset") == 0) {
+            offsetDb = atof(argv[++arg]);
+        } else if (strcmp(argv[arg], "--layer") == 0) {
+            startLayer = atoi(argv[++arg]);
+        } else if (strcmp(argv[arg], "--volume") == 0) {
+            volumeIndex = atoi(argv[++arg]);
+        } else if (strcmp(argv[arg], "--seconds") == 0) {
+            seconds = atof(argv[++arg]);
+        } else {
+            break;
+        }
+    }
+
+    if (argc < 3 || arg != argc || volumeIndex < 0 || volumeIndex > 2) {
+        fprintf(stderr, "usage: render_mix <track.ogg> <out.wav> [--script <log.txt>] [--layers <n>] [--enemy]\n"
+                        "                  [--offset <dB>] [--layer <n>] [--volume <0|1|2>] [--seconds <s>]\n");
+        return 1;
+    }
+
+    if (scriptPath != NULL) {
+        count = LoadTrace(scriptPath, &events);
+    }
+
+    start = Now();
+    LoadTrack(argv[1], &track);
+    decodeTime = Now() - start;
+
+    BuildChannelMap(&map, track.channels, layers, enemy);
+    offset = powf(10.0f, (float)offsetDb / 20.0f);
+
+    if (seconds > 0.0) {
+        ticks = (long)(seconds * TICKS_PER_SECOND + 0.5);
+    } else {
+        ticks = (track.frames * TICKS_PER_SECOND + track.sampleRate - 1) / track.sampleRate;
+        if (count > 0 && (long)events[count - 1].tick >= ticks) {
+            ticks = events[count - 1].tick + 1;
+        }
+    }
+
+    // Mixer model: one set of channel gains per tick, plus the state before
+    // the first tick so the first ramp has somewhere to start from.
+    gains = malloc((size_t)(ticks + 1) * track.channels * sizeof(float));
+    if (gains == NULL) {
+        Die("out of memory", NULL);
+    }
+
+    start = Now();
+    InitMixer();
+    ApplyCommand(OST_CMD_RESET, startLayer, 0.0f);
+    ApplyCommand(OST_CMD_SET_VOLUME, 0, GetRemasterVolume(volumeIndex));
+    StepMixer();
+    GetChannelGains(&map, offset, gains, track.channels);
+
+    for (tick = 0; tick < ticks; tick++) {
+        size_t j;
+
+        BeginTick();
+
+        // Same order as trace_replay: commands at the top of their tick;
+        // markers change nothing.
+        for (j = next; j < count && (long)events[j].tick == tick; j++) {
+            ApplyTickEvent(&events[j]);
+        }
+
+        next = j;
+
+        StepMixer();
+        GetChannelGains(&map, offset, gains + (tick + 1) * track.channels, track.channels);
+        EndTick();
+    }
+    modelTime = Now() - start;
+
+    // Gain application: even channels to the left, odd to the right.
+    frames = ticks * track.sampleRate / TICKS_PER_SECOND;
+    out = malloc((size_t)frames * 2 * sizeof(int16_t));
+    if (out == NULL) {
+        Die("out of memory", NULL);
+    }
+
+    start = Now();
+    pos = 0;
+    for (frame = 0; frame < frames; frame++) {
+        long tickStart;
+        long tickEnd;
+        float t;
+        float sum[2] = { 0.0f, 0.0f };
+        const float* from;
+        const float* to;
+
+        tick = frame * TICKS_PER_SECOND / track.sampleRate;
+        tickStart = tick * track.sampleRate / TICKS_PER_SECOND;
+        tickEnd = (tick + 1) * track.sampleRate / TICKS_PER_SECOND;
+        t = (float)(frame - tickStart) / (float)(tickEnd - tickStart);
+        from = gains + tick * track.channels;
+        to = from + track.channels;
+
+        if (pos < track.frames) {
+            const int16_t* src = track.samples + pos * track.channels;
+
+            for (i = 0; i < track.channels; i++) {
+                sum[i & 1] += src[i] * (from[i] + (to[i] - from[i]) * t);
+            }
+        }
+
+        for (i = 0; i < 2; i++) {
+            long s = lrintf(sum[i]);
+
+            if (s > 32767 || s < -32768) {
+                clipped++;
+                s = (s > 0) ? 32767 : -32768;
+            }
+            if (labs(s) > peak) {
+                peak = (int)labs(s);
+            }
+            out[frame * 2 + i] = (int16_t)s;
+        }
+
+        if (++pos >= track.loopEnd && track.loopStart >= 0) {
+            pos = track.loopStart;
+        }
+    }
+    mixTime = Now() - start;
+
+    start = Now();
+    WriteWav(argv[2], out, frames, track.sampleRate);
+    writeTime = Now() - start;
+
+    seconds = (double)frames / track.sampleRate;
+    fprintf(stderr, "render_mix: %.2f s, %d channels, %d layers%s, %zu events\n", seconds, track.channels,
+            map.layerCount, map.stemMask ? " + stem" : "", count);
+    fprintf(stderr, "  decode %8.2f ms\n", decodeTime * 1000.0);
+    fprintf(stderr, "  model  %8.2f ms (%.1f ns/tick)\n", modelTime * 1000.0, modelTime * 1e9 / (ticks + 1));
+    fprintf(stderr, "  mix    %8.2f ms (%.0fx realtime)\n", mixTime * 1000.0,
+            (mixTime > 0.0) ? seconds / mixTime : 0.0);
+    fprintf(stderr, "  write  %8.2f ms\n", writeTime * 1000.0);
+    fprintf(stderr, "  peak %.1f dBFS, %ld clipped samples\n", (peak > 0) ? 20.0 * log10(peak / 32768.0) : -INFINITY,
+            clipped);
+
+    free(out);
+    free(gains);
+    free(track.samples);
+    free(events);
+    return 0;
+}
@@ -0,0 +1,285 @@
+// Offline replayer for the mod's event trace.
+//
+// With the "Event Trace" option on, the mod logs every input its mixer reacts
+// to as "RST <tick> <event> <args>" lines. This tool runs such a log back
+// through the same mixing rules as src/soundtrack.c and prints the resulting
+// state of the main BGM player for every audio tick, so a field report turns
+// into a reproducible, diffable run:
+//
+//   trace_replay <log.txt> [--changes] [--chrome <out.json>]
+//
+// Output is CSV on stdout; --changes only prints ticks where something moved.
+// --chrome writes Chrome trace-event JSON instead (chrome://tracing, Perfetto):
+// audio frames, audio ticks, each replaced player's processing and crossfades
+// as spans, inputs and sequence starts as instants, and the mixer gains as
+// counters.
+// A summary with the event count and replay speed goes to stderr.
+//
+// Events:
+//   I                  mod initialised            P        Play_Init
+//   C <op> <arg> <v>   command applied (v x1000)  L <n>    L pressed, layer n
+//   E <v>              AudioApi_EnemyBgmSplit     U <v>    AudioApi_SubBgmBlend
+//   B <src> <v>        AudioApi_BgmBlendIntent
+//
+// The blend callbacks post their change as a command, so E, U and B are
+// markers; the blend takes effect with the C line that follows them.
+//   S <player> <seqId> <key>   sequence start (key -1 if not replaced)
+//   F <load>           audio frame, synth time against its budget (x1000)
+//   K <ns>             audio tick, time spent in AudioScript_ProcessSequences
+//   Q <player> <at> <ns>   a replaced player's processing, <at> ns into its tick
+//   W <key>            warm read of a track ahead of its cue
+//
+// The mixing rules are the mod's own, from src/mixer.h; mix_model.h feeds the
+// events to them and is shared with render_mix.c.
+
+#include <stdarg.h>
+#include <time.h>
+
+#include "mix_model.h"
+
+// -----------------------------------------------------------------------------
+// Chrome trace-event export
+
+#define TICK_USEC (1000000.0 / CROSSFADE_DURATION_TICKS) // the crossfade is one second
+#define AUDIO_FRAME_USEC (1000000.0 / 60)
+#define SLOW_FRAME_LOAD 500 // x1000, as the mod counts them
+
+enum {
+    TRACK_MIXER = 1,
+    TRACK_CROSSFADE,
+    TRACK_AUDIO_FRAME,
+    TRACK_AUDIO_TICK,
+    TRACK_INPUT,
+    TRACK_PLAYER_BASE, // one track per sequence player from here
+};
+
+static const char* const kTrackNames[] = {
+    NULL, "Mixer", "Crossfade", "Audio frames", "Audio ticks", "Game input",
+};
+
+static const char* const kPlayerNames[] = { "Main BGM", "Fanfare", "SFX", "Sub BGM", "Ambience" };
+
+static FILE* chrome;
+static int chromeEventCount;
+static long crossfadeStart = -1;
+static char lastCounters[160];
+
+static void ChromeEmit(const char* fmt, ...) {
+    va_list args;
+
+    fputs((chromeEventCount++ > 0) ? ",\n" : "\n", chrome);
+    va_start(args, fmt);
+    vfprintf(chrome, fmt, args);
+    va_end(args);
+}
+
+static void ChromeTrackName(int tid, const char* name) {
+    ChromeEmit("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", tid, name);
+}
+
+static void ChromeBegin(const char* path) {
+    int i;
+
+    chrome = fopen(path, "w");
+    if (chrome == NULL) {
+        fprintf(stderr, "trace_replay: cannot write %s\n", path);
+        exit(1);
+    }
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", chrome);
+    ChromeEmit("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Ben's RST\"}}");
+    for (i = TRACK_MIXER; i < TRACK_PLAYER_BASE; i++) {
+        ChromeTrackName(i, kTrackNames[i]);
+    }
+    for (i = 0; i < (int)(sizeof(kPlayerNames) / sizeof(kPlayerNames[0])); i++) {
+        ChromeTrackName(TRACK_PLAYER_BASE + i, kPlayerNames[i]);
+    }
+}
+
+static void ChromeSpan(const char* name, int tid, double startUsec, double durUsec, const char* args) {
+    ChromeEmit("{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.0f,\"dur\":%.0f,\"args\":{%s}}", name,
+               tid, startUsec, durUsec, args);
+}
+
+static void ChromeInstant(const char* name, int tid, unsigned long tick, const char* args) {
+    ChromeEmit("{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.0f,\"args\":{%s}}", name,
+               tid, tick * TICK_USEC, args);
+}
+
+// Mixer state after a tick's processing, only when a rounded value moved.
+static void ChromeCounters(unsigned long tick) {
+    char counters[sizeof(lastCounters)];
+
+    snprintf(counters, sizeof(counters),
+             "\"remaster\":%.3f,\"ost\":%.3f,\"duck\":%.3f,\"stem\":%.3f,\"enemy\":%d,\"sub\":%d",
+             GetLayerGain(0), GetLayerGain(1), mix.bgmDuck, mix.stemVolume,
+             mix.blendAmounts[BLEND_SOURCE_ENEMY], mix.blendAmounts[BLEND_SOURCE_SUB]);
+
+    if (strcmp(counters, lastCounters) != 0) {
+        ChromeEmit("{\"name\":\"mix\",\"ph\":\"C\",\"pid\":1,\"tid\":%d,\"ts\":%.0f,\"args\":{%s}}", TRACK_MIXER,
+                   tick * TICK_USEC, counters);
+        strcpy(lastCounters, counters);
+    }
+}
+
+static void ChromeInput(const Event* e) {
+    char args[96];
+
+    switch (e->type) {
+        case 'F':
+            snprintf(args, sizeof(args), "\"load\":%.3f", e->args[0] / 1000.0);
+            ChromeSpan((e->args[0] > SLOW_FRAME_LOAD) ? "slow audio frame" : "audio frame", TRACK_AUDIO_FRAME,
+                       e->tick * TICK_USEC, e->args[0] / 1000.0 * AUDIO_FRAME_USEC, args);
+            break;
+
+        case 'K':
+            snprintf(args, sizeof(args), "\"ns\":%d", e->args[0]);
+            ChromeSpan("audio tick", TRACK_AUDIO_TICK, e->tick * TICK_USEC, e->args[0] / 1000.0, args);
+            break;
+
+        case 'Q':
+            if (e->args[0] >= 0 && e->args[0] < (int)(sizeof(kPlayerNames) / sizeof(kPlayerNames[0]))) {
+                snprintf(args, sizeof(args), "\"ns\":%d", e->args[2]);
+                ChromeSpan("process", TRACK_PLAYER_BASE + e->args[0], e->tick * TICK_USEC + e->args[1] / 1000.0,
+                           e->args[2] / 1000.0, args);
+            }
+            break;
+
+        case 'L':
+            snprintf(args, sizeof(args), "\"layer\":%d", e->args[0]);
+            ChromeInstant("L pressed", TRACK_INPUT, e->tick, args);
+            break;
+
+        case 'P':
+            ChromeInstant("Play_Init", TRACK_INPUT, e->tick, "");
+            break;
+
+        case 'W':
+            snprintf(args, sizeof(args), "\"key\":%d", e->args[0]);
+            ChromeInstant("warm read", TRACK_INPUT, e->tick, args);
+            break;
+
+        case 'S':
+            if (e->args[0] >= 0 && e->args[0] < (int)(sizeof(kPlayerNames) / sizeof(kPlayerNames[0]))) {
+                snprintf(args, sizeof(args), "\"seqId\":%d,\"key\":%d", e->args[1], e->args[2]);
+                ChromeInstant((e->args[2] >= 0) ? "replaced sequence" : "vanilla sequence",
+                              TRACK_PLAYER_BASE + e->args[0], e->tick, args);
+            }
+            break;
+    }
+}
+
+static void ChromeEnd(unsigned long endTick) {
+    if (crossfadeStart >= 0) {
+        ChromeSpan("crossfade", TRACK_CROSSFADE, crossfadeStart * TICK_USEC, (endTick - crossfadeStart) * TICK_USEC,
+                   "");
+    }
+
+    fputs("\n]}\n", chrome);
+    fclose(chrome);
+}
+
+int main(int argc, char** argv) {
+    Event* events;
+    size_t count, next = 0;
+    unsigned long tick, lastTick;
+    int changesOnly = 0;
+    const char* chromePath = NULL;
+    char previous[256] = "";
+    clock_t start;
+    double seconds;
+    int arg;
+
+    for (arg = 2; arg < argc; arg++) {
+        if (strcmp(argv[arg], "--changes") == 0) {
+            changesOnly = 1;
+        } else if (strcmp(argv[arg], "--chrome") == 0 && arg + 1 < argc) {
+            chromePath = argv[++arg];
+        } else {
+            break;
+        }
+    }
+
+    if (argc < 2 || arg != argc) {
+        fprintf(stderr, "usage: trace_replay <log.txt> [--changes] [--chrome <out.json>]\n");
+        return 1;
+    }
+
+    count = LoadTrace(argv[1], &events);
+    if (count == 0) {
+        fprintf(stderr, "trace_replay: no RST lines in %s\n", argv[1]);
+        return 1;
+    }
+
+    InitMixer();
+    lastTick = events[count - 1].tick;
+    if (chromePath != NULL) {
+        ChromeBegin(chromePath);
+    } else {
+        printf("tick,layer,fade_in,fade_out,remaster_gain,ost_gain,duck,stem,enemy,sub,events\n");
+    }
+
+    start = clock();
+    for (tick = events[0].tick; tick <= lastTick; tick++) {
+        char row[256];
+        char notes[128] = "";
+        size_t first = next;
+        size_t i;
+
+        BeginTick();
+
+        // Commands act on the tick they are stamped with.
+        for (i = next; i < count && events[i].tick == tick; i++) {
+            ApplyTickEvent(&events[i]);
+        }
+
+        if (chrome != NULL && mix.fadeTimer == CROSSFADE_DURATION_TICKS && crossfadeStart < 0) {
+            crossfadeStart = tick;
+        }
+
+        StepMixer();
+        EndTick();
+
+        if (chrome != NULL) {
+            if (crossfadeStart >= 0 && mix.fadeTimer == 0) {
+                ChromeSpan("crossfade", TRACK_CROSSFADE, crossfadeStart * TICK_USEC,
+                           (tick + 1 - crossfadeStart) * TICK_USEC, "");
+                crossfadeStart = -1;
+            }
+            ChromeCounters(tick);
+        }
+
+        snprintf(row, sizeof(row), "%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%d,%d", mix.activeChannel,
+                 mix.fadeInVolume, mix.fadeOutVolume, GetLayerGain(0), GetLayerGain(1), mix.bgmDuck,
+                 mix.stemVolume, mix.blendAmounts[BLEND_SOURCE_ENEMY], mix.blendAmounts[BLEND_SOURCE_SUB]);
+
+        // Markers arrived after this tick's processing.
+        for (; next < count && events[next].tick == tick; next++) {
+            size_t used = strlen(notes);
+
+            if (chrome != NULL) {
+                ChromeInput(&events[next]);
+            }
+            if (used + 16 < sizeof(notes)) {
+                snprintf(notes + used, sizeof(notes) - used, "%s%c:%d", used > 0 ? " " : "", events[next].type,
+                         events[next].args[0]);
+            }
+        }
+
+        if (chrome == NULL && (!changesOnly || next != first || strcmp(row, previous) != 0)) {
+            printf("%lu,%s,%s\n", tick, row, notes);
+        }
+        strcpy(previous, row);
+    }
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    if (chrome != NULL) {
+        ChromeEnd(lastTick + 1);
+    }
+
+    fprintf(stderr, "trace_replay: %zu events over %lu ticks, %.1f ns/tick\n", count,
+            lastTick - events[0].tick + 1, seconds * 1e9 / (double)(lastTick - events[0].tick + 1));
+
+    free(events);
+    return 0;
+}
@@ -0,0 +1,773 @@
+// Offline VADPCM encoder for the low-CPU asset pack.
+//
+// Re-encodes one track of the audio/ pack to the game's native VADPCM format so
+// it can be played by the vanilla synth instead of an Ogg decoder:
+//
+//   vadpcm_pack <in.ogg|in.wav> <out.bank> <out.h> <out.txt>
+//       Trains an order-2, 4-predictor codebook for the track, encodes every
+//       channel into <out.bank> (raw sample bank data for AudioApi_AddSampleBank),
+//       writes the AdpcmBook, one AdpcmLoop per channel and the channel layout to
+//       <out.h>, and a one-line size / decode-cost comparison against the source
+//       to <out.txt>.
+//
+// Loop points come from the Ogg LOOPSTART and LOOPEND / LOOPLENGTH comments or
+// the first loop of a WAV smpl chunk; untagged tracks get a one-shot AdpcmLoop.
+//
+//   vadpcm_pack --report <report.txt> <track.txt>...
+//       Collects the per-track lines into a table with totals.
+//
+// Ogg input needs libvorbisfile; build with -DVADPCM_NO_VORBIS for WAV-only.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef VADPCM_NO_VORBIS
+#include <vorbis/vorbisfile.h>
+#endif
+
+#define ORDER 2
+#define NUM_PREDICTORS 4 // 2 bits of predictor index
+#define FRAME_SAMPLES 16
+#define FRAME_BYTES 9
+#define BOOK_SHIFT 11 // codebook entries are Q11
+#define MAX_SCALE 12
+#define TRAIN_ITERATIONS 12
+#define SILENCE_ENERGY 64.0 // frames quieter than this don't steer the codebook
+
+typedef struct {
+    int16_t* samples; // interleaved
+    uint32_t frames;
+    uint32_t channels;
+    uint32_t sampleRate;
+    long loopStart; // -1 if the track doesn't loop
+    long loopEnd;   // exclusive, -1 for the end of the track
+    double decodeSeconds; // time spent decoding the source, 0 if not measured
+} Pcm;
+
+typedef struct {
+    double a[NUM_PREDICTORS][ORDER];
+    int16_t book[NUM_PREDICTORS][ORDER][8];
+} Codebook;
+
+static void Die(const char* msg, const char* arg) {
+    fprintf(stderr, "vadpcm_pack: %s%s%s\n", msg, arg ? ": " : "", arg ? arg : "");
+    exit(1);
+}
+
+static double Now(void) {
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static long FileSize(const char* path) {
+    FILE* f = fopen(path, "rb");
+    long size;
+
+    if (f == NULL) {
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fclose(f);
+    return size;
+}
+
+static const char* BaseName(const char* path) {
+    const char* slash = strrchr(path, '/');
+    const char* backslash = strrchr(path, '\\');
+
+    if (backslash != NULL && (slash == NULL || backslash > slash)) {
+        slash = backslash;
+    }
+    return (slash != NULL) ? slash + 1 : path;
+}
+
+static int HasSuffix(const char* s, const char* suffix) {
+    size_t n = strlen(s);
+    size_t m = strlen(suffix);
+
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+// -----------------------------------------------------------------------------
+// Input
+
+static uint32_t ReadLe(const uint8_t* p, int bytes) {
+    uint32_t v = 0;
+    int i;
+
+    for (i = bytes - 1; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static void LoadWav(const char* path, Pcm* pcm) {
+    FILE* f = fopen(path, "rb");
+    uint8_t hdr[12];
+    uint8_t chunk[8];
+    uint8_t fmt[16];
+    uint8_t smpl[60];
+    int haveFmt = 0;
+
+    if (f == NULL || fread(hdr, 1, 12, f) != 12 || memcmp(hdr, "RIFF", 4) || memcmp(hdr + 8, "WAVE", 4)) {
+        Die("not a RIFF/WAVE file", path);
+    }
+
+    while (fread(chunk, 1, 8, f) == 8) {
+        uint32_t size = ReadLe(chunk + 4, 4);
+
+        if (!memcmp(chunk, "fmt ", 4)) {
+            if (size < 16 || fread(fmt, 1, 16, f) != 16) {
+                Die("bad fmt chunk", path);
+            }
+            fseek(f, size - 16 + (size & 1), SEEK_CUR);
+            if (ReadLe(fmt, 2) != 1 || ReadLe(fmt + 14, 2) != 16) {
+                Die("only 16-bit PCM WAV is supported", path);
+            }
+            pcm->channels = ReadLe(fmt + 2, 2);
+            pcm->sampleRate = ReadLe(fmt + 4, 4);
+            haveFmt = 1;
+        } else if (!memcmp(chunk, "data", 4) && haveFmt) {
+            uint32_t count = size / 2;
+            uint8_t* raw = malloc(size);
+            uint32_t i;
+
+            pcm->samples = malloc(count * sizeof(int16_t));
+            if (raw == NULL || pcm->samples == NULL || fread(raw, 1, size, f) != size) {
+                Die("truncated data chunk", path);
+            }
+            for (i = 0; i < count; i++) {
+                pcm->samples[i] = (int16_t)ReadLe(raw + i * 2, 2);
+            }
+            free(raw);
+            pcm->frames = count / pcm->channels;
+            fseek(f, size & 1, SEEK_CUR);
+        } else if (!memcmp(chunk, "smpl", 4) && size >= sizeof(smpl)) {
+            // First sample loop; its end sample is inclusive.
+            if (fread(smpl, 1, sizeof(smpl), f) != sizeof(smpl)) {
+                Die("bad smpl chunk", path);
+            }
+            fseek(f, size - sizeof(smpl) + (size & 1), SEEK_CUR);
+            if (ReadLe(smpl + 28, 4) > 0) {
+                pcm->loopStart = ReadLe(smpl + 44, 4);
+                pcm->loopEnd = ReadLe(smpl + 48, 4) + 1;
+            }
+        } else {
+            fseek(f, size + (size & 1), SEEK_CUR);
+        }
+    }
+    fclose(f);
+
+    if (pcm->samples == NULL) {
+        Die("no data chunk", path);
+    }
+}
+
+#ifndef VADPCM_NO_VORBIS
+static long GetTag(vorbis_comment* vc, const char* tag) {
+    char* value = vorbis_comment_query(vc, tag, 0);
+
+    return (value != NULL) ? atol(value) : -1;
+}
+
+static void LoadOgg(const char* path, Pcm* pcm) {
+    OggVorbis_File vf;
+    vorbis_info* vi;
+    vorbis_comment* vc;
+    long loopLength;
+    size_t capacity;
+    size_t used = 0;
+    double start;
+    int section;
+    long got;
+
+    if (ov_fopen(path, &vf) != 0) {
+        Die("cannot open Ogg Vorbis file", path);
+    }
+
+    vi = ov_info(&vf, -1);
+    vc = ov_comment(&vf, -1);
+    pcm->channels = vi->channels;
+    pcm->sampleRate = vi->rate;
+    pcm->loopStart = GetTag(vc, "LOOPSTART");
+    pcm->loopEnd = GetTag(vc, "LOOPEND");
+    loopLength = GetTag(vc, "LOOPLENGTH");
+    if (pcm->loopEnd < 0 && pcm->loopStart >= 0 && loopLength > 0) {
+        pcm->loopEnd = pcm->loopStart + loopLength;
+    }
+
+    capacity = (size_t)ov_pcm_total(&vf, -1) * pcm->channels + 4096;
+    pcm->samples = malloc(capacity * sizeof(int16_t));
+    if (pcm->samples == NULL) {
+        Die("out of memory", path);
+    }
+
+    start = Now();
+    for (;;) {
+        if (capacity - used < 4096) {
+            capacity *= 2;
+            pcm->samples = realloc(pcm->samples, capacity * sizeof(int16_t));
+            if (pcm->samples == NULL) {
+                Die("out of memory", path);
+            }
+        }
+        got = ov_read(&vf, (char*)(pcm->samples + used), (int)((capacity - used) * sizeof(int16_t)), 0, 2, 1,
+                      &section);
+        if (got <= 0) {
+            break;
+        }
+        used += got / sizeof(int16_t);
+    }
+    pcm->decodeSeconds = Now() - start;
+
+    ov_clear(&vf);
+    pcm->frames = used / pcm->channels;
+}
+#endif
+
+static void LoadPcm(const char* path, Pcm* pcm) {
+    memset(pcm, 0, sizeof(*pcm));
+    pcm->loopStart = -1;
+    pcm->loopEnd = -1;
+
+    if (HasSuffix(path, ".wav")) {
+        LoadWav(path, pcm);
+    } else {
+#ifndef VADPCM_NO_VORBIS
+        LoadOgg(path, pcm);
+#else
+        Die("built without Ogg support", path);
+#endif
+    }
+
+    if (pcm->loopEnd < 0 || pcm->loopEnd > (long)pcm->frames) {
+        pcm->loopEnd = pcm->frames;
+    }
+    if (pcm->loopStart >= pcm->loopEnd) {
+        pcm->loopStart = -1;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Codebook training
+//
+// Each 16-sample frame contributes the normal equations of an order-2 linear
+// predictor. The predictors are clustered with LBG splitting + k-means, using
+// each frame's prediction error energy as the distortion, so the four entries
+// end up covering the spectral shapes the track actually uses.
+
+typedef struct {
+    double r00, r01, r11; // autocovariance of the two history taps
+    double r0, r1;        // cross terms with the sample being predicted
+    double e;             // sample energy
+} FrameStats;
+
+static double PredictionError(const FrameStats* s, const double* a) {
+    return s->e - 2.0 * (a[0] * s->r0 + a[1] * s->r1) +
+           a[0] * a[0] * s->r00 + 2.0 * a[0] * a[1] * s->r01 + a[1] * a[1] * s->r11;
+}
+
+// Keeps both poles comfortably inside the unit circle.
+static void Stabilise(double* a) {
+    if (a[1] < -0.95) {
+        a[1] = -0.95;
+    } else if (a[1] > 0.95) {
+        a[1] = 0.95;
+    }
+    if (fabs(a[0]) > 0.98 * (1.0 - a[1])) {
+        a[0] = (a[0] < 0 ? -0.98 : 0.98) * (1.0 - a[1]);
+    }
+}
+
+static void SolvePredictor(const FrameStats* s, double* a) {
+    double det = s->r00 * s->r11 - s->r01 * s->r01;
+
+    if (fabs(det) < 1e-9 * (s->r00 * s->r11 + 1.0)) {
+        a[0] = (s->r00 > 0.0) ? s->r0 / s->r00 : 0.0;
+        a[1] = 0.0;
+    } else {
+        a[0] = (s->r0 * s->r11 - s->r1 * s->r01) / det;
+        a[1] = (s->r1 * s->r00 - s->r0 * s->r01) / det;
+    }
+    Stabilise(a);
+}
+
+static void AccumulateStats(FrameStats* dst, const FrameStats* src) {
+    dst->r00 += src->r00;
+    dst->r01 += src->r01;
+    dst->r11 += src->r11;
+    dst->r0 += src->r0;
+    dst->r1 += src->r1;
+    dst->e += src->e;
+}
+
+static size_t CollectFrameStats(const Pcm* pcm, FrameStats** out) {
+    size_t capacity = (size_t)(pcm->frames / FRAME_SAMPLES + 1) * pcm->channels;
+    FrameStats* stats = calloc(capacity, sizeof(FrameStats));
+    size_t count = 0;
+    uint32_t ch, f, i;
+
+    if (stats == NULL) {
+        Die("out of memory", NULL);
+    }
+
+    for (ch = 0; ch < pcm->channels; ch++) {
+        for (f = ORDER; f + FRAME_SAMPLES <= pcm->frames; f += FRAME_SAMPLES) {
+            FrameStats* s = &stats[count];
+
+            memset(s, 0, sizeof(*s));
+            for (i = f; i < f + FRAME_SAMPLES; i++) {
+                double x = pcm->samples[i * pcm->channels + ch];
+                double x1 = pcm->samples[(i - 1) * pcm->channels + ch];
+                double x2 = pcm->samples[(i - 2) * pcm->channels + ch];
+
+                s->r00 += x1 * x1;
+                s->r01 += x1 * x2;
+                s->r11 += x2 * x2;
+                s->r0 += x * x1;
+                s->r1 += x * x2;
+                s->e += x * x;
+            }
+            if (s->e / FRAME_SAMPLES > SILENCE_ENERGY) {
+                count++;
+            }
+        }
+    }
+
+    *out = stats;
+    return count;
+}
+
+static void TrainCodebook(const Pcm* pcm, Codebook* cb) {
+    FrameStats* stats;
+    FrameStats sums[NUM_PREDICTORS];
+    FrameStats all;
+    size_t count = CollectFrameStats(pcm, &stats);
+    size_t n;
+    int active = 1;
+    int k, iter;
+
+    memset(&all, 0, sizeof(all));
+    for (n = 0; n < count; n++) {
+        AccumulateStats(&all, &stats[n]);
+    }
+    SolvePredictor(&all, cb->a[0]);
+
+    while (active < NUM_PREDICTORS) {
+        // Split every predictor into a slightly perturbed pair.
+        for (k = 0; k < active; k++) {
+            cb->a[active + k][0] = cb->a[k][0] * 0.99 + 0.01;
+            cb->a[active + k][1] = cb->a[k][1] * 0.99 - 0.01;
+            cb->a[k][0] = cb->a[k][0] * 1.01 - 0.01;
+            cb->a[k][1] = cb->a[k][1] * 1.01 + 0.01;
+            Stabilise(cb->a[k]);
+            Stabilise(cb->a[active + k]);
+        }
+        active *= 2;
+
+        for (iter = 0; iter < TRAIN_ITERATIONS; iter++) {
+            memset(sums, 0, sizeof(sums));
+            for (n = 0; n < count; n++) {
+                int best = 0;
+                double bestErr = PredictionError(&stats[n], cb->a[0]);
+
+                for (k = 1; k < active; k++) {
+                    double err = PredictionError(&stats[n], cb->a[k]);
+                    if (err < bestErr) {
+                        bestErr = err;
+                        best = k;
+                    }
+                }
+                AccumulateStats(&sums[best], &stats[n]);
+            }
+            for (k = 0; k < active; k++) {
+                if (sums[k].r00 > 0.0) {
+                    SolvePredictor(&sums[k], cb->a[k]);
+                }
+            }
+        }
+    }
+
+    free(stats);
+}
+
+// Expands each predictor into the 2x8 table the synth's decoder walks:
+// row 0 is the response to x[-2], row 1 the response to x[-1], which doubles
+// as the impulse response applied to the residual.
+static void ExpandCodebook(Codebook* cb) {
+    int k, i;
+
+    for (k = 0; k < NUM_PREDICTORS; k++) {
+        double a1 = cb->a[k][0];
+        double a2 = cb->a[k][1];
+        double h[2][8];
+
+        for (i = 0; i < 8; i++) {
+            double prev1 = (i >= 1) ? h[0][i - 1] : 0.0;
+            double prev2 = (i >= 2) ? h[0][i - 2] : (i == 0 ? 1.0 : 0.0);
+            h[0][i] = a1 * prev1 + a2 * prev2;
+
+            prev1 = (i >= 1) ? h[1][i - 1] : 1.0;
+            prev2 = (i >= 2) ? h[1][i - 2] : (i == 1 ? 1.0 : 0.0);
+            h[1][i] = a1 * prev1 + a2 * prev2;
+        }
+
+        for (i = 0; i < 8; i++) {
+            double v0 = floor(h[0][i] * (1 << BOOK_SHIFT) + 0.5);
+            double v1 = floor(h[1][i] * (1 << BOOK_SHIFT) + 0.5);
+
+            cb->book[k][0][i] = (int16_t)fmax(-32768.0, fmin(32767.0, v0));
+            cb->book[k][1][i] = (int16_t)fmax(-32768.0, fmin(32767.0, v1));
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Frame codec
+
+static int16_t Clamp16(int32_t v) {
+    return (v < -32768) ? -32768 : (v > 32767) ? 32767 : (int16_t)v;
+}
+
+// Decodes one half frame exactly as the synth does. res holds the residuals
+// already shifted by the frame's scale.
+static void DecodeHalf(const int16_t book[ORDER][8], const int32_t* res, int16_t* hist, int16_t* out) {
+    int i, j;
+
+    for (i = 0; i < 8; i++) {
+        int32_t total = book[0][i] * hist[0] + book[1][i] * hist[1] + (res[i] << BOOK_SHIFT);
+
+        for (j = 0; j < i; j++) {
+            total += book[1][i - 1 - j] * res[j];
+        }
+        out[i] = Clamp16(total >> BOOK_SHIFT);
+    }
+    hist[0] = out[6];
+    hist[1] = out[7];
+}
+
+// Quantises one frame with a given predictor and scale, in closed loop against
+// the decoder. Returns the squared error; nibbles and hist receive the result.
+static double QuantiseFrame(const int16_t book[ORDER][8], int scale, const int16_t* in, int16_t* hist,
+                            int8_t* nibbles) {
+    int16_t out[8];
+    int32_t res[8];
+    double err = 0.0;
+    int half, i, j;
+
+    for (half = 0; half < 2; half++) {
+        const int16_t* hIn = in + half * 8;
+        int8_t* hNib = nibbles + half * 8;
+
+        for (i = 0; i < 8; i++) {
+            int32_t pred = book[0][i] * hist[0] + book[1][i] * hist[1];
+            int32_t q;
+
+            for (j = 0; j < i; j++) {
+                pred += book[1][i - 1 - j] * res[j];
+            }
+            q = (int32_t)floor(((double)hIn[i] * (1 << BOOK_SHIFT) - pred) / (double)(1 << (BOOK_SHIFT + scale)) + 0.5);
+            hNib[i] = (int8_t)((q < -8) ? -8 : (q > 7) ? 7 : q);
+            res[i] = hNib[i] * (1 << scale);
+        }
+
+        DecodeHalf(book, res, hist, out);
+        for (i = 0; i < 8; i++) {
+            double d = (double)hIn[i] - out[i];
+            err += d * d;
+        }
+    }
+
+    return err;
+}
+
+static void EncodeFrame(const Codebook* cb, const int16_t* in, int16_t* hist, uint8_t* dst) {
+    int8_t nibbles[FRAME_SAMPLES], bestNibbles[FRAME_SAMPLES];
+    int16_t trialHist[ORDER], bestHist[ORDER] = { hist[0], hist[1] };
+    double bestErr = -1.0;
+    int bestPred = 0, bestScale = 0;
+    int k, scale, i;
+
+    for (k = 0; k < NUM_PREDICTORS; k++) {
+        // The open-loop residual peak picks the starting scale; one step above
+        // it is tried too, since the closed loop can overshoot.
+        double peak = 0.0;
+        int startScale = 0;
+
+        for (i = 0; i < FRAME_SAMPLES; i++) {
+            double x1 = (i >= 1) ? in[i - 1] : hist[1];
+            double x2 = (i >= 2) ? in[i - 2] : (i == 1) ? hist[1] : hist[0];
+            double r = fabs(in[i] - (cb->a[k][0] * x1 + cb->a[k][1] * x2));
+
+            if (r > peak) {
+                peak = r;
+            }
+        }
+        while (startScale < MAX_SCALE && peak / (1 << startScale) > 7.5) {
+            startScale++;
+        }
+
+        for (scale = startScale; scale <= startScale + 1 && scale <= MAX_SCALE; scale++) {
+            double err;
+
+            trialHist[0] = hist[0];
+            trialHist[1] = hist[1];
+            err = QuantiseFrame(cb->book[k], scale, in, trialHist, nibbles);
+            if (bestErr < 0.0 || err < bestErr) {
+                bestErr = err;
+                bestPred = k;
+                bestScale = scale;
+                memcpy(bestNibbles, nibbles, sizeof(nibbles));
+                bestHist[0] = trialHist[0];
+                bestHist[1] = trialHist[1];
+            }
+        }
+    }
+
+    dst[0] = (uint8_t)((bestScale << 4) | bestPred);
+    for (i = 0; i < FRAME_SAMPLES / 2; i++) {
+        dst[1 + i] = (uint8_t)(((bestNibbles[i * 2] & 0xF) << 4) | (bestNibbles[i * 2 + 1] & 0xF));
+    }
+    hist[0] = bestHist[0];
+    hist[1] = bestHist[1];
+}
+
+static void DecodeFrame(const Codebook* cb, const uint8_t* src, int16_t* hist, int16_t* out) {
+    int scale = src[0] >> 4;
+    int pred = src[0] & 0xF;
+    int32_t res[FRAME_SAMPLES];
+    int i;
+
+    for (i = 0; i < FRAME_SAMPLES / 2; i++) {
+        res[i * 2] = ((int32_t)(int8_t)(src[1 + i] & 0xF0) >> 4) * (1 << scale);
+        res[i * 2 + 1] = ((int32_t)(int8_t)(src[1 + i] << 4) >> 4) * (1 << scale);
+    }
+    DecodeHalf(cb->book[pred], res, hist, out);
+    DecodeHalf(cb->book[pred], res + 8, hist, out + 8);
+}
+
+// -----------------------------------------------------------------------------
+// Track packing
+
+static void Pack(const char* inPath, const char* bankPath, const char* headerPath, const char* reportPath) {
+    Pcm pcm;
+    Codebook cb;
+    uint32_t lead, sampleCount, loopStart, loopEnd, frameCount, channelBytes, ch, f, i;
+    uint8_t* bank;
+    int16_t* decoded;
+    int16_t(*loopState)[FRAME_SAMPLES];
+    double signal = 0.0, noise = 0.0, start, vadpcmSeconds, snr;
+    char name[256];
+    char* dot;
+    FILE* out;
+    long oggBytes;
+
+    LoadPcm(inPath, &pcm);
+    if (pcm.channels == 0 || pcm.frames == 0) {
+        Die("no audio", inPath);
+    }
+
+    snprintf(name, sizeof(name), "%s", BaseName(inPath));
+    dot = strrchr(name, '.');
+    if (dot != NULL) {
+        *dot = '\0';
+    }
+
+    TrainCodebook(&pcm, &cb);
+    ExpandCodebook(&cb);
+
+    // The track is delayed by up to 15 samples of silence so the loop starts on
+    // a frame boundary: the synth then resumes decoding at exactly that frame,
+    // with the loop's predictor state standing in for the history.
+    lead = (pcm.loopStart >= 0) ? (FRAME_SAMPLES - pcm.loopStart % FRAME_SAMPLES) % FRAME_SAMPLES : 0;
+    sampleCount = pcm.frames + lead;
+    loopStart = (pcm.loopStart >= 0) ? pcm.loopStart + lead : 0;
+    loopEnd = pcm.loopEnd + lead;
+
+    frameCount = (sampleCount + FRAME_SAMPLES - 1) / FRAME_SAMPLES;
+    channelBytes = (frameCount * FRAME_BYTES + 15) & ~15u; // sample data is 16-byte aligned
+    bank = calloc((size_t)channelBytes * pcm.channels, 1);
+    decoded = malloc((size_t)frameCount * FRAME_SAMPLES * sizeof(int16_t));
+    loopState = calloc(pcm.channels, sizeof(*loopState));
+    if (bank == NULL || decoded == NULL || loopState == NULL) {
+        Die("out of memory", inPath);
+    }
+
+    // Encode each channel as its own sample, one after another in the bank.
+    for (ch = 0; ch < pcm.channels; ch++) {
+        int16_t hist[ORDER] = { 0, 0 };
+
+        for (f = 0; f < frameCount; f++) {
+            int16_t frame[FRAME_SAMPLES];
+
+            for (i = 0; i < FRAME_SAMPLES; i++) {
+                uint32_t s = f * FRAME_SAMPLES + i;
+                frame[i] = (s >= lead && s < sampleCount) ? pcm.samples[(s - lead) * pcm.channels + ch] : 0;
+            }
+            EncodeFrame(&cb, frame, hist, bank + (size_t)ch * channelBytes + f * FRAME_BYTES);
+        }
+    }
+
+    // Decode everything back: measures the synth-side cost and the quality.
+    // The loop's predictor state is the decoder output of the frame before the
+    // loop start, which is what the synth's history holds on the first pass.
+    vadpcmSeconds = 0.0;
+    for (ch = 0; ch < pcm.channels; ch++) {
+        int16_t hist[ORDER] = { 0, 0 };
+
+        start = Now();
+        for (f = 0; f < frameCount; f++) {
+            DecodeFrame(&cb, bank + (size_t)ch * channelBytes + f * FRAME_BYTES, hist, decoded + f * FRAME_SAMPLES);
+        }
+        vadpcmSeconds += Now() - start;
+
+        if (pcm.loopStart >= 0 && loopStart >= FRAME_SAMPLES) {
+            memcpy(loopState[ch], decoded + loopStart - FRAME_SAMPLES, sizeof(loopState[ch]));
+        }
+        for (i = 0; i < pcm.frames; i++) {
+            double x = pcm.samples[i * pcm.channels + ch];
+            double d = x - decoded[i + lead];
+            signal += x * x;
+            noise += d * d;
+        }
+    }
+    snr = (noise > 0.0) ? 10.0 * log10(signal / noise) : 99.0;
+
+    out = fopen(bankPath, "wb");
+    if (out == NULL || fwrite(bank, 1, (size_t)channelBytes * pcm.channels, out) != (size_t)channelBytes * pcm.channels) {
+        Die("cannot write", bankPath);
+    }
+    fclose(out);
+
+    out = fopen(headerPath, "w");
+    if (out == NULL) {
+        Die("cannot write", headerPath);
+    }
+    fprintf(out, "// Generated by tools/vadpcm_pack.c from %s. Do not edit.\n", BaseName(inPath));
+    fprintf(out, "#define %s_SAMPLE_RATE %u\n", name, pcm.sampleRate);
+    fprintf(out, "#define %s_CHANNELS %u\n", name, pcm.channels);
+    fprintf(out, "#define %s_SAMPLE_COUNT %u\n", name, sampleCount);
+    fprintf(out, "#define %s_CHANNEL_BYTES %u // channel n starts at n * CHANNEL_BYTES in the bank\n", name,
+            channelBytes);
+    fprintf(out, "#define %s_LOOP_START %u\n", name, loopStart);
+    fprintf(out, "#define %s_LOOP_END %u\n", name, loopEnd);
+    fprintf(out, "\n");
+
+    // AdpcmBook ends in a one-entry codeBook, so the table is laid out behind
+    // its header and handed out through a cast.
+    fprintf(out, "static struct {\n    AdpcmBookHeader header;\n    s16 codeBook[%d];\n} %s_BookData = {\n",
+            ORDER * NUM_PREDICTORS * 8, name);
+    fprintf(out, "    { %d, %d },\n    {\n", ORDER, NUM_PREDICTORS);
+    for (f = 0; f < NUM_PREDICTORS; f++) {
+        for (ch = 0; ch < ORDER; ch++) {
+            fprintf(out, "       ");
+            for (i = 0; i < 8; i++) {
+                fprintf(out, " %6d,", cb.book[f][ch][i]);
+            }
+            fprintf(out, "\n");
+        }
+    }
+    fprintf(out, "    }\n};\n");
+    fprintf(out, "#define %s_Book ((AdpcmBook*)&%s_BookData)\n\n", name, name);
+
+    // One loop per channel sample: same points, each with its own decoder state.
+    // A count of 0 plays the sample once.
+    fprintf(out, "static AdpcmLoop %s_Loop[%u] = {\n", name, pcm.channels);
+    for (ch = 0; ch < pcm.channels; ch++) {
+        fprintf(out, "    { %u, %u, %s, %u, {", loopStart, (pcm.loopStart >= 0) ? loopEnd : sampleCount,
+                (pcm.loopStart >= 0) ? "0xFFFFFFFF" : "0", sampleCount);
+        for (i = 0; i < FRAME_SAMPLES; i++) {
+            fprintf(out, "%s%d", (i == 0) ? " " : ", ", loopState[ch][i]);
+        }
+        fprintf(out, " } },\n");
+    }
+    fprintf(out, "};\n");
+    fclose(out);
+
+    oggBytes = HasSuffix(inPath, ".ogg") ? FileSize(inPath) : -1;
+    out = fopen(reportPath, "w");
+    if (out == NULL) {
+        Die("cannot write", reportPath);
+    }
+    // name, source bytes, bank bytes, SNR, ns per output sample for each decoder
+    fprintf(out, "%s %ld %u %.1f %.2f %.2f\n", name, oggBytes, channelBytes * pcm.channels, snr,
+            pcm.decodeSeconds * 1e9 / ((double)pcm.frames * pcm.channels),
+            vadpcmSeconds * 1e9 / ((double)pcm.frames * pcm.channels));
+    fclose(out);
+
+    free(bank);
+    free(decoded);
+    free(loopState);
+    free(pcm.samples);
+}
+
+static int Report(const char* reportPath, int count, char** tracks) {
+    FILE* out = fopen(reportPath, "w");
+    double totalOgg = 0.0, totalBank = 0.0, oggBank = 0.0, oggNs = 0.0, vadpcmNs = 0.0;
+    int i, measured = 0, oggMeasured = 0;
+
+    if (out == NULL) {
+        Die("cannot write", reportPath);
+    }
+
+    fprintf(out, "%-40s %12s %12s %7s %8s %12s %12s\n", "track", "ogg bytes", "vadpcm bytes", "ratio", "snr dB",
+            "ogg ns/smp", "vadpcm ns/smp");
+
+    for (i = 0; i < count; i++) {
+        FILE* in = fopen(tracks[i], "r");
+        char name[256];
+        long ogg;
+        unsigned long bank;
+        double snr, ns0, ns1;
+
+        if (in == NULL || fscanf(in, "%255s %ld %lu %lf %lf %lf", name, &ogg, &bank, &snr, &ns0, &ns1) != 6) {
+            Die("bad track report", tracks[i]);
+        }
+        fclose(in);
+
+        if (ogg > 0) {
+            fprintf(out, "%-40s %12ld %12lu %7.2f %8.1f %12.2f %12.2f\n", name, ogg, bank, (double)bank / ogg, snr,
+                    ns0, ns1);
+        } else {
+            fprintf(out, "%-40s %12s %12lu %7s %8.1f %12s %12.2f\n", name, "-", bank, "-", snr, "-", ns1);
+        }
+        // WAV inputs have no Ogg size or decode cost, so only Ogg rows feed the
+        // ratio and the Ogg mean.
+        if (ogg > 0) {
+            totalOgg += ogg;
+            oggBank += bank;
+            oggNs += ns0;
+            oggMeasured++;
+        }
+        totalBank += bank;
+        vadpcmNs += ns1;
+        measured++;
+    }
+
+    if (measured > 0) {
+        fprintf(out, "%-40s %12.0f %12.0f %7.2f %8s %12.2f %12.2f\n", "TOTAL / mean", totalOgg, totalBank,
+                (totalOgg > 0.0) ? oggBank / totalOgg : 0.0, "", (oggMeasured > 0) ? oggNs / oggMeasured : 0.0,
+                vadpcmNs / measured);
+    }
+    fclose(out);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && strcmp(argv[1], "--report") == 0) {
+        return Report(argv[2], argc - 3, argv + 3);
+    }
+
+    if (argc != 5) {
+        fprintf(stderr, "usage: vadpcm_pack <in.ogg|in.wav> <out.bank> <out.h> <out.txt>\n"
+                        "       vadpcm_pack --report <report.txt> <track.txt>...\n");
+        return 1;
+    }
+
+    Pack(argv[1], argv[2], argv[3], argv[4]);
+    return 0;
+}